@@ -11,7 +11,14 @@
 #include <fstream>
 #include <chrono>
 #include <list>
+#include <vector>
 #include "test_driver_decls.h"
+#include "td_phase.h"
+#include "td_compare.h"
+#include "td_outliers.h"
+#include "td_scaling.h"
+#include "td_profile.h"
+#include "td_isolation.h"
 
 
 #ifdef TD_USE_INPUT
@@ -37,6 +44,15 @@ TD_HANDLE_OUTPUT;
 #ifndef TD_POST_TIMER
 #define TD_POST_TIMER
 #endif // TD_POST_TIMER
+#ifndef TD_INPUT_CLASS
+#define TD_INPUT_CLASS std::string("all")
+#endif // TD_INPUT_CLASS
+#ifndef TD_INPUT_DESCRIPTION
+#define TD_INPUT_DESCRIPTION std::string()
+#endif // TD_INPUT_DESCRIPTION
+#if defined(TD_USE_COMPARISON) || defined(TD_USE_OUTLIERS)
+#define __TD_KEEP_ELAPSED
+#endif
 
 #ifdef TD_INPUT
 #define input TD_PTRCAST_UNSAFE(TD_INPUT, _input)
@@ -92,6 +108,16 @@ struct TD_TestFunction
 	{
 		this->print_base_result();
 		this->print_result();
+		#ifdef TD_USE_PHASES
+		this->phases.print();
+		#endif
+		#ifdef TD_USE_ISOLATION
+		this->usage.print();
+		#endif
+		#ifdef TD_USE_PROFILER
+		const std::size_t start = this->header.find_first_not_of(" \n");
+		this->profile.write(this->header.substr(start, this->header.find('\n', start) - start));
+		#endif
 		std::cout << std::endl;
 	}
 private:
@@ -99,6 +125,12 @@ private:
 	{
 		total_search = 0;
 		search_times = 0;
+		#ifdef TD_USE_PHASES
+		phases.reset();
+		#endif
+		#ifdef TD_USE_PROFILER
+		profile.reset();
+		#endif
 	}
 
 	void print_base_result() const
@@ -118,6 +150,22 @@ private:
 	std::string header;
 	// test results for printing
 	int total_search = 0, search_times = 0;
+	#ifdef __TD_KEEP_ELAPSED
+	// time of the last call, in nanoseconds
+	long long last_elapsed = 0;
+	#endif
+	#ifdef TD_USE_PHASES
+	// time spent in each TD_PHASE of the function
+	TD_PhaseTable phases;
+	#endif
+	#ifdef TD_USE_PROFILER
+	// stacks sampled during calls to the function
+	TD_Profile profile;
+	#endif
+	#ifdef TD_USE_ISOLATION
+	// resources used by the process the function ran in
+	TD_ResourceUsage usage;
+	#endif
     // Pointer-to-function under test
 	R(*f)(Args...);
 };
@@ -137,6 +185,14 @@ public:
 	void run_tests(const std::string& filename);
 	#endif
 	void print_results() const;
+	#if defined(TD_USE_SCALING) && defined(__TD_PREPARE_INPUT)
+	// run each test from 1..max_threads threads at once, on every input in the file
+	void run_scaling_tests(const std::string& filename, int max_threads);
+	#endif
+	#if defined(TD_USE_OUTLIERS) && defined(__TD_PREPARE_INPUT)
+	// write the slowest inputs of the last run_tests(filename) to a new file
+	long dump_slowest(const std::string& filename) const;
+	#endif
 	TD_TestDriver& add_test(const std::string& header, R(*test_func)(Args...));
 
 	#ifdef __TD_PREPARE_INPUT
@@ -145,18 +201,45 @@ public:
 private:
 	// reset testing metadata
 	void reset();
+	// run each test on every input
+	void run_inputs();
+	#ifdef TD_USE_ISOLATION
+	// run_inputs() for each test in a child process of its own
+	void run_isolated();
+	#endif
 	// run each test on the TD_TestInput provided as an argument
 	void run(const TD_TestInput* _input);
 	#ifdef __TD_PREPARE_INPUT
 	// test file
 	static inline std::ifstream infile;
 	#endif
+	// header of each function, without formatting
+	std::vector<std::string> names() const;
 	// print helper function
 	void print_one_result(int total, int times) const;
 	// helper functions to get timing results
 	int timed(const TD_TestInput* _input, TD_TestOutput* _output, TD_TestFunction<R, Args...>*);
+	#ifdef TD_USE_SCALING
+	// time one call in nanoseconds without recording anything, so it can run on several threads
+	long long timed_call(const TD_TestInput* _input, TD_TestFunction<R, Args...>*) const;
+	#endif
 	// function or system being tested (as a function)
 	std::list<TD_TestFunction<R, Args...>*> test_funcs;
+	#ifdef TD_USE_COMPARISON
+	// per-input times of every function against the first
+	TD_Comparison comparison;
+	#endif
+	#ifdef TD_USE_OUTLIERS
+	// slowest inputs of every function
+	TD_Outliers outliers;
+	// index of the next input, and where the current one was read from in infile
+	long record_index = 0;
+	std::streamoff record_begin = -1, record_end = -1;
+	#ifdef __TD_PREPARE_INPUT
+	// file read by the last run_tests(filename)
+	std::string infile_name;
+	#endif
+	#endif
 };
 
 // Deduction guide
@@ -189,20 +272,62 @@ void TD_TestDriver<R, Args...>::print_results() const
 	{
 		test_func->_print_result();
 	}
+	#ifdef TD_USE_COMPARISON
+	this->comparison.print(this->names());
+	#endif
+	#ifdef TD_USE_OUTLIERS
+	this->outliers.print(this->names());
+	#endif
 }
 
+template<typename R, typename ...Args>
+std::vector<std::string> TD_TestDriver<R, Args...>::names() const
+{
+	std::vector<std::string> names;
+	for(auto test_func : test_funcs)
+	{
+		// the header without its underline or the padding used to align it
+		const std::string& header = test_func->header;
+		const std::size_t start = header.find_first_not_of(" \n");
+		names.push_back(header.substr(start, header.find('\n', start) - start));
+	}
+	return names;
+}
+
+#if defined(TD_USE_OUTLIERS) && defined(__TD_PREPARE_INPUT)
+template<typename R, typename ...Args>
+long TD_TestDriver<R, Args...>::dump_slowest(const std::string& filename) const
+{
+	if(this->infile_name.empty()) return -1;
+	return this->outliers.dump(this->infile_name, filename);
+}
+#endif
+
 template<typename R, typename ...Args>
 void TD_TestDriver<R, Args...>::run(const TD_TestInput* _input)
 {
+	#ifdef __TD_KEEP_ELAPSED
+	std::vector<long long> elapsed;
+	#endif
 	for(auto test_func : test_funcs)
 	{
 		TD_OUTPUT _output;
 		test_func->search_times += this->timed(_input, &_output, test_func);
 		++(test_func->total_search);
+		#ifdef __TD_KEEP_ELAPSED
+		elapsed.push_back(test_func->last_elapsed);
+		#endif
 		#ifdef __TD_HANDLE_OUTPUT
 		__TD_HANDLE_OUTPUT(test_func, &_output);
 		#endif
 	}
+	#ifdef TD_USE_COMPARISON
+	this->comparison.add(TD_INPUT_CLASS, elapsed);
+	#endif
+	#ifdef TD_USE_OUTLIERS
+	this->outliers.add(this->record_index++, this->record_begin, this->record_end,
+		[_input]() { return std::string(TD_INPUT_DESCRIPTION); }, elapsed);
+	#endif
 }
 
 template<typename R, typename ...Args>
@@ -210,6 +335,17 @@ void TD_TestDriver<R, Args...>::run_tests()
 {
 	this->reset();
 
+	#ifdef TD_USE_ISOLATION
+	this->run_isolated();
+	#else
+	this->run_inputs();
+	print_results();
+	#endif
+}
+
+template<typename R, typename ...Args>
+void TD_TestDriver<R, Args...>::run_inputs()
+{
 	#ifdef __TD_PREPARE_INPUT
 	// read & run tests
 	while(infile)
@@ -217,15 +353,102 @@ void TD_TestDriver<R, Args...>::run_tests()
 	#endif
 		TD_INPUT _input;
 		#ifdef __TD_PREPARE_INPUT
+		#ifdef TD_USE_OUTLIERS
+		this->record_begin = infile.tellg();
+		#endif
 		if(!__TD_PREPARE_INPUT(&_input)) break;
+		#ifdef TD_USE_OUTLIERS
+		// -1 after the last record, if reading it hit the end of the file
+		this->record_end = infile.tellg();
+		#endif
 		#endif
 		run(&_input);
 	#ifdef __TD_PREPARE_INPUT
 	}
 	#endif
+}
 
-	print_results();
+#ifdef TD_USE_ISOLATION
+template<typename R, typename ...Args>
+void TD_TestDriver<R, Args...>::run_isolated()
+{
+	#ifdef __TD_PREPARE_INPUT
+	// the children share infile's file offset with the driver, so it is rewound after each
+	const std::streampos input_start = infile.tellg();
+	#endif
+	const std::vector<std::string> names = this->names();
+	std::vector<TD_IsolatedResult> results(test_funcs.size());
+	std::size_t function = 0;
+	for(auto test_func : test_funcs)
+	{
+		// output still buffered at the fork would be written by the child as well
+		std::cout.flush();
+		std::fflush(stdout);
+		int channel[2];
+		if(pipe(channel))
+		{
+			std::perror("pipe");
+			return;
+		}
+		const pid_t child = fork();
+		if(child == 0)
+		{
+			close(channel[0]);
+			const TD_ResourceUsage start = TD_ResourceUsage::current();
+			this->test_funcs.remove_if([test_func](auto other) { return other != test_func; });
+			this->run_inputs();
+			test_func->usage = TD_ResourceUsage::since(start);
+			this->print_results();
+			std::cout.flush();
+			std::fflush(stdout);
+			const TD_IsolatedResult result{test_func->total_search, test_func->search_times, test_func->usage};
+			const char* bytes = reinterpret_cast<const char*>(&result);
+			for(std::size_t sent = 0; sent < sizeof(result);)
+			{
+				const ssize_t written = write(channel[1], bytes + sent, sizeof(result) - sent);
+				if(written <= 0) _exit(1);
+				sent += written;
+			}
+			_exit(0);
+		}
+		close(channel[1]);
+		if(child < 0)
+		{
+			std::perror("fork");
+			close(channel[0]);
+			return;
+		}
+
+		TD_IsolatedResult& result = results[function];
+		char* bytes = reinterpret_cast<char*>(&result);
+		std::size_t received = 0;
+		while(received < sizeof(result))
+		{
+			const ssize_t got = read(channel[0], bytes + received, sizeof(result) - received);
+			if(got <= 0) break;
+			received += got;
+		}
+		close(channel[0]);
+		int status = 0;
+		waitpid(child, &status, 0);
+		if(received < sizeof(result) || !WIFEXITED(status) || WEXITSTATUS(status))
+		{
+			std::cerr << names[function] << ": isolated run failed" << std::endl;
+			result = TD_IsolatedResult();
+		}
+		test_func->total_search = result.total_search;
+		test_func->search_times = result.search_times;
+		test_func->usage = result.usage;
+		++function;
+
+		#ifdef __TD_PREPARE_INPUT
+		infile.clear();
+		infile.seekg(input_start);
+		#endif
+	}
+	TD_print_isolated_results(&names[0], &results[0], results.size());
 }
+#endif
 
 #ifdef __TD_PREPARE_INPUT
 template<typename R, typename ...Args>
@@ -233,6 +456,9 @@ void TD_TestDriver<R, Args...>::run_tests(const std::string& filename)
 {
 	// open the file
 	infile.open(filename);
+	#ifdef TD_USE_OUTLIERS
+	this->infile_name = filename;
+	#endif
 	this->run_tests();
 	infile.close();
 }
@@ -243,14 +469,101 @@ int TD_TestDriver<R, Args...>::timed(const TD_TestInput* _input, TD_TestOutput*
 {
 	using namespace std::chrono;
 	TD_PRE_TIMER
+	#ifdef TD_USE_PROFILER
+	TD_profile_resume(&test_func->profile);
+	#endif
+	#ifdef TD_USE_PHASES
+	high_resolution_clock::time_point start, end;
+	{
+	// routes TD_PHASE markers on this thread to test_func until the call returns. It is
+	// opened before start and closed after end, so its bookkeeping is not timed
+	TD_PhaseCall phase_call(test_func->phases);
+	start = high_resolution_clock::now();
+	__TD_RETURN_TARGET (*test_func)(TD_ARGS);
+	end = high_resolution_clock::now();
+	}
+	#else
 	auto start = high_resolution_clock::now();
 	__TD_RETURN_TARGET (*test_func)(TD_ARGS);
 	auto end = high_resolution_clock::now();
+	#endif
+	#ifdef TD_USE_PROFILER
+	TD_profile_pause();
+	test_func->profile.drain();
+	#endif
 	auto time = duration_cast<microseconds>(end - start);
+	#ifdef __TD_KEEP_ELAPSED
+	test_func->last_elapsed = duration_cast<nanoseconds>(end - start).count();
+	#endif
 	TD_POST_TIMER
 	return time.count();
 }
 
+#if defined(TD_USE_SCALING) && defined(__TD_PREPARE_INPUT)
+template<typename R, typename ...Args>
+void TD_TestDriver<R, Args...>::run_scaling_tests(const std::string& filename, int max_threads)
+{
+	// read every input up front, so that the threads only have to copy them
+	std::vector<TD_INPUT> inputs;
+	infile.open(filename);
+	while(infile)
+	{
+		TD_INPUT _input;
+		if(!__TD_PREPARE_INPUT(&_input)) break;
+		inputs.push_back(_input);
+	}
+	infile.close();
+
+	const std::vector<std::string> names = this->names();
+	auto name = names.begin();
+	for(auto test_func : test_funcs)
+	{
+		TD_ScalingTable table;
+		for(int threads : TD_scaling_thread_counts(max_threads))
+		{
+			TD_StartGate gate(threads);
+			std::vector<std::vector<long long>> latencies(threads);
+			std::vector<std::thread> workers;
+			for(int thread = 0; thread < threads; ++thread)
+			{
+				workers.emplace_back([this, &inputs, &gate, &latencies, test_func, thread]()
+				{
+					std::vector<TD_INPUT> own(inputs);
+					latencies[thread].reserve(own.size());
+					gate.arrive();
+					for(const auto& _input : own) latencies[thread].push_back(this->timed_call(&_input, test_func));
+				});
+			}
+			gate.wait_for_all();
+			const auto start = std::chrono::steady_clock::now();
+			gate.release();
+			for(auto& worker : workers) worker.join();
+			const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+			std::vector<long long> all;
+			for(const auto& thread_latencies : latencies) all.insert(all.end(), thread_latencies.begin(), thread_latencies.end());
+			table.add(threads, seconds.count(), all);
+		}
+		table.print(*name++);
+	}
+}
+
+template<typename R, typename ...Args>
+long long TD_TestDriver<R, Args...>::timed_call(const TD_TestInput* _input, TD_TestFunction<R, Args...>* test_func) const
+{
+	using namespace std::chrono;
+	TD_OUTPUT result;
+	TD_TestOutput* _output = &result;
+	TD_PRE_TIMER
+	auto start = high_resolution_clock::now();
+	__TD_RETURN_TARGET (*test_func)(TD_ARGS);
+	auto end = high_resolution_clock::now();
+	auto time = duration_cast<microseconds>(end - start);
+	TD_POST_TIMER
+	return duration_cast<nanoseconds>(end - start).count();
+}
+#endif
+
 template<typename R, typename ...Args>
 void TD_TestDriver<R, Args...>::reset()
 {
@@ -258,6 +571,13 @@ void TD_TestDriver<R, Args...>::reset()
 	{
 		test_func->_reset();
 	}
+	#ifdef TD_USE_COMPARISON
+	this->comparison.reset();
+	#endif
+	#ifdef TD_USE_OUTLIERS
+	this->outliers.reset();
+	this->record_index = 0;
+	#endif
 }
 
 #endif
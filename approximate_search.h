@@ -0,0 +1,327 @@
+//----------------------------------------------------------------------
+// FILE: approximate_search.h
+// DESC: Bit-parallel approximate search. Shift-And extended to k
+//       mismatches (Hamming distance), and Myers' bit-vector algorithm
+//       for edit distance, both over any number of 64-bit words, plus a
+//       batched Myers that runs several short patterns in SIMD lanes
+//----------------------------------------------------------------------
+
+#ifndef APPROXIMATE_SEARCH_H
+#define APPROXIMATE_SEARCH_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+
+/**
+ * A single approximate occurance. pattern_id is the index of the pattern for the batched
+ * search and 0 otherwise, and distance is the number of mismatches or edits.
+ *
+ * What offset refers to depends on the distance. With mismatches an occurance is exactly
+ * as long as the pattern, and offset is the index of its first character. With edits the
+ * same end can be reached from several starts, so offset is the index of its last
+ * character, as in Myers' formulation
+ */
+struct approximate_match
+{
+	int pattern_id;
+	std::size_t offset;
+	int distance;
+};
+
+// Bits per word of the bit-parallel state
+constexpr std::size_t APPROXIMATE_WORD_BITS = 64;
+
+/**
+ * Per character bit masks of a pattern, one bit per pattern position spread over as many
+ * words as the pattern needs: bit i of mask(c) is set when pattern[i] == c
+ */
+class approximate_masks
+{
+public:
+	explicit approximate_masks(const std::string& pattern)
+	: words((pattern.length() + APPROXIMATE_WORD_BITS - 1) / APPROXIMATE_WORD_BITS)
+	, masks((UCHAR_MAX + 1) * words, 0)
+	{
+		for(std::size_t index = 0; index < pattern.length(); ++index)
+		{
+			const unsigned char c = pattern[index];
+			masks[c * words + index / APPROXIMATE_WORD_BITS] |= std::uint64_t(1) << (index % APPROXIMATE_WORD_BITS);
+		}
+	}
+
+	const std::uint64_t* mask(unsigned char c) const
+	{
+		return &this->masks[c * this->words];
+	}
+
+	const std::size_t words;
+private:
+	std::vector<std::uint64_t> masks;
+};
+
+/**
+ * Appends every alignment of pattern in text with at most max_mismatches mismatching
+ * characters to matches, in increasing offset order, with the fewest mismatches for that
+ * alignment. Returns true if there were any.
+ *
+ * Shift-And keeps one state vector per number of mismatches j: bit i of R[j] is set when
+ * pattern[0...i] matches the text ending here with at most j mismatches. A character
+ * either matches, keeping R[j], or is substituted, promoting R[j-1]:
+ *     R[j] = ((R[j] << 1 | 1) & mask(c)) | (R[j-1] << 1 | 1)
+ * With the state in several words the shifts carry from each word into the next.
+ *
+ * Reference
+ * - R. Baeza-Yates and G. H. Gonnet, "A new approach to text searching", Commun. ACM
+ *   35(10), 1992
+ */
+bool shift_and_search(const std::string& pattern, int max_mismatches, const std::string& text, std::vector<approximate_match>& matches)
+{
+	const std::size_t pattern_length = pattern.length();
+	if(!pattern_length || max_mismatches < 0 || text.length() < pattern_length) return false;
+	const std::size_t levels = max_mismatches + 1;
+
+	const approximate_masks masks(pattern);
+	const std::size_t words = masks.words;
+	const std::size_t last_word = (pattern_length - 1) / APPROXIMATE_WORD_BITS;
+	const std::uint64_t last_bit = std::uint64_t(1) << ((pattern_length - 1) % APPROXIMATE_WORD_BITS);
+	std::vector<std::uint64_t> states(levels * words, 0);
+	std::vector<std::uint64_t> shifted(levels * words);
+
+	bool found = false;
+	for(std::size_t position = 0; position < text.length(); ++position)
+	{
+		const std::uint64_t* mask = masks.mask(text[position]);
+		for(std::size_t level = 0; level < levels; ++level)
+		{
+			std::uint64_t carry = 1;
+			for(std::size_t word = 0; word < words; ++word)
+			{
+				const std::uint64_t state = states[level * words + word];
+				shifted[level * words + word] = state << 1 | carry;
+				carry = state >> (APPROXIMATE_WORD_BITS - 1);
+			}
+		}
+		for(std::size_t word = 0; word < words; ++word) states[word] = shifted[word] & mask[word];
+		for(std::size_t level = 1; level < levels; ++level)
+		{
+			for(std::size_t word = 0; word < words; ++word)
+			{
+				states[level * words + word] = (shifted[level * words + word] & mask[word]) | shifted[(level - 1) * words + word];
+			}
+		}
+
+		for(std::size_t level = 0; level < levels; ++level)
+		{
+			if(!(states[level * words + last_word] & last_bit)) continue;
+			found = true;
+			matches.push_back({0, position + 1 - pattern_length, int(level)});
+			break;
+		}
+	}
+	return found;
+}
+
+/**
+ * Appends every position in text where an occurance of pattern with at most max_edits
+ * insertions, deletions and substitutions ends to matches, in increasing offset order,
+ * with the smallest edit distance of any occurance ending there. Returns true if there
+ * were any.
+ *
+ * Myers' algorithm runs the column of the usual edit distance table as two bit vectors,
+ * the positions where the column goes up by one (Pv) and down by one (Mv) from the row
+ * above, and updates both for each text character with a handful of word operations.
+ * Patterns longer than one word are split into blocks, each passing the change in its
+ * bottom row on to the next.
+ *
+ * References
+ * - G. Myers, "A fast bit-vector algorithm for approximate string matching based on
+ *   dynamic programming", J. ACM 46(3), 1999
+ * - H. Hyyro, "A bit-vector algorithm for computing Levenshtein and Damerau edit
+ *   distances", Nordic J. Computing 10(1), 2003
+ */
+bool myers_search(const std::string& pattern, int max_edits, const std::string& text, std::vector<approximate_match>& matches)
+{
+	const std::size_t pattern_length = pattern.length();
+	if(!pattern_length || max_edits < 0) return false;
+
+	const approximate_masks masks(pattern);
+	const std::size_t blocks = masks.words;
+	const std::uint64_t last_bit = std::uint64_t(1) << ((pattern_length - 1) % APPROXIMATE_WORD_BITS);
+	const std::uint64_t high_bit = std::uint64_t(1) << (APPROXIMATE_WORD_BITS - 1);
+	// The first column is 0, 1, ..., m: every vertical step is +1
+	std::vector<std::uint64_t> plus(blocks, ~std::uint64_t(0));
+	std::vector<std::uint64_t> minus(blocks, 0);
+	// Bottom entry of the column, the edit distance of the best occurance ending here
+	std::ptrdiff_t score = pattern_length;
+
+	bool found = false;
+	for(std::size_t position = 0; position < text.length(); ++position)
+	{
+		const std::uint64_t* mask = masks.mask(text[position]);
+		// Horizontal change entering the top of the block: the top row is all zeros, since
+		// an occurance can start anywhere
+		int carry = 0;
+		for(std::size_t block = 0; block < blocks; ++block)
+		{
+			const std::uint64_t block_bit = block + 1 == blocks ? last_bit : high_bit;
+			std::uint64_t equal = mask[block];
+			const std::uint64_t pv = plus[block];
+			const std::uint64_t mv = minus[block];
+
+			const std::uint64_t xv = equal | mv;
+			if(carry < 0) equal |= 1;
+			const std::uint64_t xh = (((equal & pv) + pv) ^ pv) | equal;
+			std::uint64_t ph = mv | ~(xh | pv);
+			std::uint64_t mh = pv & xh;
+
+			const int carry_out = (ph & block_bit) ? 1 : (mh & block_bit) ? -1 : 0;
+			ph <<= 1;
+			mh <<= 1;
+			if(carry < 0) mh |= 1;
+			else if(carry > 0) ph |= 1;
+			plus[block] = mh | ~(xv | ph);
+			minus[block] = ph & xv;
+			carry = carry_out;
+		}
+		score += carry;
+
+		if(score > max_edits) continue;
+		found = true;
+		matches.push_back({0, position, int(score)});
+	}
+	return found;
+}
+
+// Patterns searched side by side by myers_search_batch()
+constexpr std::size_t MYERS_BATCH_LANES = 4;
+
+/**
+ * myers_search() for several patterns in one pass over the text. Patterns of up to one
+ * word are packed MYERS_BATCH_LANES at a time into the lanes of a GCC vector, so the word
+ * operations for all of them run as SIMD instructions where the target has them. Longer
+ * patterns are searched one at a time with myers_search().
+ *
+ * pattern_id is the index into patterns. Each pattern's matches are in increasing offset
+ * order, but the matches of different patterns are interleaved
+ */
+bool myers_search_batch(const std::vector<std::string>& patterns, int max_edits, const std::string& text, std::vector<approximate_match>& matches)
+{
+	if(max_edits < 0) return false;
+	bool found = false;
+	std::vector<int> batched;
+	for(std::size_t pattern_id = 0; pattern_id < patterns.size(); ++pattern_id)
+	{
+		const std::size_t pattern_length = patterns[pattern_id].length();
+		if(!pattern_length) continue;
+		if(pattern_length <= APPROXIMATE_WORD_BITS)
+		{
+			batched.push_back(pattern_id);
+			continue;
+		}
+		const std::size_t first = matches.size();
+		found |= myers_search(patterns[pattern_id], max_edits, text, matches);
+		for(std::size_t match = first; match < matches.size(); ++match) matches[match].pattern_id = pattern_id;
+	}
+
+#ifdef __GNUC__
+	typedef std::uint64_t lanes __attribute__((vector_size(MYERS_BATCH_LANES * sizeof(std::uint64_t))));
+	typedef std::int64_t signed_lanes __attribute__((vector_size(MYERS_BATCH_LANES * sizeof(std::int64_t))));
+
+	std::vector<lanes> lane_masks(UCHAR_MAX + 1);
+	for(std::size_t batch = 0; batch < batched.size(); batch += MYERS_BATCH_LANES)
+	{
+		const std::size_t lane_count = batched.size() - batch < MYERS_BATCH_LANES ? batched.size() - batch : MYERS_BATCH_LANES;
+		// Unused lanes have no last bit, so their score never changes from the initial
+		// INT64_MAX and they never report
+		lanes last_bit = {};
+		signed_lanes score;
+		for(std::size_t lane = 0; lane < MYERS_BATCH_LANES; ++lane) score[lane] = INT64_MAX;
+		for(auto& mask : lane_masks) mask = lanes{};
+		for(std::size_t lane = 0; lane < lane_count; ++lane)
+		{
+			const std::string& pattern = patterns[batched[batch + lane]];
+			for(std::size_t index = 0; index < pattern.length(); ++index)
+			{
+				lane_masks[(unsigned char)pattern[index]][lane] |= std::uint64_t(1) << index;
+			}
+			last_bit[lane] = std::uint64_t(1) << (pattern.length() - 1);
+			score[lane] = pattern.length();
+		}
+
+		lanes plus = ~lanes{};
+		lanes minus = {};
+		for(std::size_t position = 0; position < text.length(); ++position)
+		{
+			const lanes equal = lane_masks[(unsigned char)text[position]];
+			const lanes xv = equal | minus;
+			const lanes xh = (((equal & plus) + plus) ^ plus) | equal;
+			lanes ph = minus | ~(xh | plus);
+			lanes mh = plus & xh;
+			// Comparisons give -1 in the lanes where they hold
+			score -= (signed_lanes)((ph & last_bit) != 0);
+			score += (signed_lanes)((mh & last_bit) != 0);
+			ph <<= 1;
+			mh <<= 1;
+			plus = mh | ~(xv | ph);
+			minus = ph & xv;
+
+			for(std::size_t lane = 0; lane < lane_count; ++lane)
+			{
+				if(score[lane] > max_edits) continue;
+				found = true;
+				matches.push_back({batched[batch + lane], position, int(score[lane])});
+			}
+		}
+	}
+#else
+	for(int pattern_id : batched)
+	{
+		const std::size_t first = matches.size();
+		found |= myers_search(patterns[pattern_id], max_edits, text, matches);
+		for(std::size_t match = first; match < matches.size(); ++match) matches[match].pattern_id = pattern_id;
+	}
+#endif
+	return found;
+}
+
+/**
+ * Baseline for myers_search(): the edit distance table filled in one column at a time,
+ * O(pattern_length) work per text character. Same results as myers_search()
+ *
+ * Reference
+ * - P. H. Sellers, "The theory and computation of evolutionary distances: pattern
+ *   recognition", J. Algorithms 1(4), 1980
+ */
+bool sellers_search(const std::string& pattern, int max_edits, const std::string& text, std::vector<approximate_match>& matches)
+{
+	const std::size_t pattern_length = pattern.length();
+	if(!pattern_length || max_edits < 0) return false;
+
+	std::vector<std::size_t> column(pattern_length + 1);
+	for(std::size_t row = 0; row <= pattern_length; ++row) column[row] = row;
+
+	bool found = false;
+	for(std::size_t position = 0; position < text.length(); ++position)
+	{
+		// diagonal is the previous column's entry in the row above
+		std::size_t diagonal = column[0];
+		for(std::size_t row = 1; row <= pattern_length; ++row)
+		{
+			const std::size_t substituted = diagonal + (pattern[row - 1] != text[position]);
+			diagonal = column[row];
+			std::size_t best = column[row] + 1;
+			if(column[row - 1] + 1 < best) best = column[row - 1] + 1;
+			if(substituted < best) best = substituted;
+			column[row] = best;
+		}
+		if(column[pattern_length] > std::size_t(max_edits)) continue;
+		found = true;
+		matches.push_back({0, position, int(column[pattern_length])});
+	}
+	return found;
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include "test_driver_decls.h"
+#include "search_corpus.h"
+#include "approximate_search.h"
+
+// Harness configuration for approximate search. The records are grouped by text, and every
+// function gets the patterns of one text's records along with the largest distance to accept,
+// and reports (pattern, offset, distance) triples. Single-pattern engines run once per pattern
+
+#define TD_ARGS *input->patterns, approximate_max_distance, input->text, input->matches
+#define TD_RETURN_TO output->success
+#define TD_PRE_TIMER input->matches.clear();
+#define TD_POST_TIMER output->matched = input->matches.size(); \
+	output->distance_total = 0; \
+	for(const auto& match : input->matches) output->distance_total += match.distance;
+#define TD_INPUT ApproximateSearch
+#define TD_OUTPUT Results
+#define TD_DATA Metrics
+
+// Largest number of mismatches or edits accepted. The driver program sets it before
+// run_tests()
+int approximate_max_distance = 1;
+
+struct ApproximateSearch : TD_TestInput
+{
+	const std::vector<std::string>* patterns;
+	std::string text;
+	std::vector<approximate_match> matches;
+};
+struct Results : TD_TestOutput
+{
+	bool success;
+	std::size_t matched;
+	std::size_t distance_total;
+};
+
+TD_EXTEND
+struct Metrics : TD_TestMetricsBase
+{
+	TD_METRICS(Metrics)
+	{}
+
+	std::size_t match_count = 0;
+	std::size_t distance_total = 0;
+	int success_count = 0;
+
+	void print_result() const
+	{
+		using namespace std;
+		if(!this->success_count && this->match_count) return;
+
+		cout << "  Search" << " Found....: " << this->success_count << '\n';
+		cout << "  Search" << " Matches..: " << this->match_count
+			 << " occurances\n";
+		cout << " Average" << " Distance.: " << ((1.0 * this->distance_total) / this->match_count)
+			 << '\n';
+	}
+
+	void reset()
+	{
+		this->success_count = 0;
+		this->match_count = 0;
+		this->distance_total = 0;
+	}
+};
+
+typedef bool (*approximate_engine)(const std::string&, int, const std::string&, std::vector<approximate_match>&);
+
+/**
+ * Runs engine for each pattern in turn, with pattern_id set to the pattern's index
+ */
+bool search_each(approximate_engine engine, const std::vector<std::string>& patterns, int max_distance, const std::string& text, std::vector<approximate_match>& matches)
+{
+	bool found = false;
+	for(std::size_t pattern_id = 0; pattern_id < patterns.size(); ++pattern_id)
+	{
+		const std::size_t first = matches.size();
+		found |= engine(patterns[pattern_id], max_distance, text, matches);
+		for(std::size_t match = first; match < matches.size(); ++match) matches[match].pattern_id = pattern_id;
+	}
+	return found;
+}
+
+bool sellers_each(const std::vector<std::string>& patterns, int max_distance, const std::string& text, std::vector<approximate_match>& matches)
+{
+	return search_each(sellers_search, patterns, max_distance, text, matches);
+}
+
+bool myers_each(const std::vector<std::string>& patterns, int max_distance, const std::string& text, std::vector<approximate_match>& matches)
+{
+	return search_each(myers_search, patterns, max_distance, text, matches);
+}
+
+bool shift_and_each(const std::vector<std::string>& patterns, int max_distance, const std::string& text, std::vector<approximate_match>& matches)
+{
+	return search_each(shift_and_search, patterns, max_distance, text, matches);
+}
+
+/**
+ * Checks myers_search_batch() against myers_search() one pattern at a time, on patterns
+ * around the word length and more of them than fill one batch, in a text over a small
+ * alphabet so that every distance up to max_distance occurs. Returns false if any pattern's
+ * matches differ
+ */
+bool myers_batch_check(int max_distance)
+{
+	std::string text;
+	unsigned state = 1;
+	for(int index = 0; index < 4096; ++index)
+	{
+		state = state * 1103515245 + 12345;
+		text += "acgt"[(state >> 16) & 3];
+	}
+	std::vector<std::string> patterns;
+	for(std::size_t length : {1, 3, 8, 17, 63, 64, 65, 100, 5})
+	{
+		patterns.push_back(text.substr(length * 7, length));
+	}
+
+	const auto sorted = [](std::vector<approximate_match> matches)
+	{
+		std::vector<std::pair<int, std::pair<std::size_t, int>>> found;
+		for(const approximate_match& match : matches) found.push_back({match.pattern_id, {match.offset, match.distance}});
+		std::sort(found.begin(), found.end());
+		return found;
+	};
+	std::vector<approximate_match> expected, batched;
+	myers_each(patterns, max_distance, text, expected);
+	myers_search_batch(patterns, max_distance, text, batched);
+	return sorted(batched) == sorted(expected);
+}
+
+#define TD_USE_INPUT
+#define TD_USE_OUTPUT
+
+#include "TestDriver.h"
+
+// The whole corpus is read on the first call and its records grouped by text, then one text
+// is handed out per call with the patterns of its records. State is dropped at the end so the
+// next run_tests() starts over
+TD_PREPARE_INPUT
+{
+	static std::vector<std::pair<std::string, std::vector<std::string>>> groups;
+	static std::size_t next_group = 0;
+	static bool read = false;
+
+	if(!read)
+	{
+		// Position of each distinct text in groups
+		std::unordered_map<std::string, std::size_t> group_positions;
+		std::string pattern, text;
+		while(read_corpus_record(TD_infile, pattern, text))
+		{
+			const auto position = group_positions.emplace(text, groups.size());
+			if(position.second) groups.emplace_back(text, std::vector<std::string>());
+			groups[position.first->second].second.push_back(pattern);
+		}
+		read = true;
+		// The stream hit end of file above, but the driver keeps calling while it is good
+		TD_infile.clear();
+	}
+	if(next_group == groups.size())
+	{
+		groups.clear();
+		next_group = 0;
+		read = false;
+		return false;
+	}
+
+	input->patterns = &groups[next_group].second;
+	input->text = groups[next_group++].first;
+	return true;
+}
+
+TD_HANDLE_OUTPUT
+{
+	data->match_count += output->matched;
+	data->distance_total += output->distance_total;
+	data->success_count += output->success;
+}
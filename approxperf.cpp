@@ -0,0 +1,43 @@
+//----------------------------------------------------------------------
+// FILE: approxperf.cpp
+// DESC: Driver program for the bit-parallel approximate search engines
+//----------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+#include <cstdlib>
+#include "approximate_search_tests.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	if(argc > 3)
+	{
+		std::cerr << "usage: " << argv[0] << " [filename] [max_distance]" << std::endl;
+		return 1;
+	}
+	// Use default file if no input file given
+	string file(argc >= 2 ? argv[1] : "test_in.txt");
+	approximate_max_distance = argc == 3 ? atoi(argv[2]) : 1;
+	if(approximate_max_distance < 0)
+	{
+		std::cerr << argv[0] << ": max_distance must not be negative" << std::endl;
+		return 1;
+	}
+
+	if(!myers_batch_check(approximate_max_distance))
+	{
+		std::cerr << "batched Myers disagrees with Myers at max_distance " << approximate_max_distance << std::endl;
+		return 1;
+	}
+
+	// Edit distance: Myers against the dynamic programming table it simulates, and against
+	// itself with a text's patterns searched side by side. All three find the same matches
+	TD_TestDriver td = TD_TestDriver("   Sellers (edit distance)", sellers_each);
+	td.add_test("     Myers (edit distance)", myers_each);
+	td.add_test("     Myers (batch of four)", myers_search_batch);
+	// Mismatches only, so it finds fewer occurances than the edit distance engines
+	td.add_test("  Shift-And (k mismatches)", shift_and_each);
+	td.run_tests(file);
+}
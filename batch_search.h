@@ -0,0 +1,109 @@
+//----------------------------------------------------------------------
+// FILE: batch_search.h
+// DESC: Boyer-Moore over many (pattern, text) jobs at once, compiling
+//       each distinct pattern once for every job that uses it
+//----------------------------------------------------------------------
+
+#ifndef BATCH_SEARCH_H
+#define BATCH_SEARCH_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <numeric>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include "match_sinks.h"
+#include "boyermoore.h"
+
+/**
+ * One search of a batch. Both strings are borrowed and have to outlive the batch
+ */
+struct search_job
+{
+	const std::string* pattern;
+	const std::string* text;
+};
+
+// How much of the next job's text is prefetched while the current one is searched. Large
+// enough to cover the start of the next scan, small enough to leave the current text and
+// the pattern tables in cache
+constexpr std::size_t BATCH_PREFETCH_BYTES = 16 << 10;
+constexpr std::size_t BATCH_CACHE_LINE = 64;
+
+/**
+ * Searches every job in jobs[0...job_count-1], calling sink(job, offset) for each match,
+ * where job is the index of the job. A sink that returns false stops the search of that
+ * job only. Returns the number of jobs with at least one match.
+ *
+ * Jobs are grouped by pattern and each group is searched with one boyermoore_pattern and
+ * one Apostolico-Giancarlo ring, so preprocessing and table allocation happen once per
+ * distinct pattern instead of once per job. Within a group, the start of the next text is
+ * prefetched before the current one is scanned. Matches of one job are reported in
+ * increasing offset order, but jobs are visited by group rather than in index order
+ */
+template<typename Sink>
+std::size_t batch_search(const search_job* jobs, std::size_t job_count, Sink&& sink)
+{
+	// Job indexes sorted by pattern, so each group of jobs with the same pattern is a run
+	std::vector<std::size_t> order(job_count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [jobs](std::size_t left, std::size_t right)
+	{
+		return *jobs[left].pattern < *jobs[right].pattern;
+	});
+
+	std::size_t found = 0;
+	for(std::size_t group = 0; group < job_count;)
+	{
+		const std::string& pattern = *jobs[order[group]].pattern;
+		std::size_t group_end = group + 1;
+		while(group_end < job_count && *jobs[order[group_end]].pattern == pattern) ++group_end;
+
+		const std::size_t pattern_length = pattern.length();
+		std::unique_ptr<boyermoore_pattern> compiled;
+		std::unique_ptr<apostolico_giancarlo_ring> apostolico_giancarlo_skip;
+		if(pattern_length >= 2)
+		{
+			compiled.reset(new boyermoore_pattern(pattern));
+			apostolico_giancarlo_skip.reset(new apostolico_giancarlo_ring(pattern_length));
+		}
+
+		for(std::size_t next = group; next < group_end; ++next)
+		{
+			const std::size_t job = order[next];
+			const std::string& text = *jobs[job].text;
+			if(next + 1 < group_end)
+			{
+				const std::string& upcoming = *jobs[order[next + 1]].text;
+				const std::size_t prefetched = upcoming.length() < BATCH_PREFETCH_BYTES ? upcoming.length() : BATCH_PREFETCH_BYTES;
+				for(std::size_t line = 0; line < prefetched; line += BATCH_CACHE_LINE) __builtin_prefetch(upcoming.c_str() + line);
+			}
+			if(!pattern_length || text.length() < pattern_length) continue;
+
+			bool matched = false;
+			auto report = [&matched, &sink, job](std::size_t offset)
+			{
+				matched = true;
+				return report_match([&sink, job](std::size_t offset) { return sink(job, offset); }, offset);
+			};
+			if(pattern_length == 1)
+			{
+				const char* const end = text.c_str() + text.length();
+				for(const char* hit = text.c_str(); (hit = (const char*)std::memchr(hit, pattern[0], end - hit)); ++hit)
+				{
+					if(!report(hit - text.c_str())) break;
+				}
+			} else {
+				apostolico_giancarlo_skip->reset();
+				boyermoore_scan(*compiled, *apostolico_giancarlo_skip, text.c_str(), text.length(), pattern_length - 1, report);
+			}
+			found += matched;
+		}
+		group = group_end;
+	}
+	return found;
+}
+
+#endif
@@ -0,0 +1,112 @@
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include "test_driver_decls.h"
+#include "search_corpus.h"
+#include "match_sinks.h"
+#include "boyermoore.h"
+#include "batch_search.h"
+
+// Harness configuration for batch timing. Each call of a function under test searches a
+// whole batch of records rather than one, and the time is reported per record, amortized
+// over the batch
+
+#define TD_ARGS input->jobs
+#define TD_RETURN_TO output->matched
+#define TD_POST_TIMER output->records = input->jobs.size(); output->elapsed = time;
+#define TD_INPUT BatchSearch
+#define TD_OUTPUT Results
+#define TD_DATA Metrics
+
+// Records per batch, 0 for the whole corpus in one batch. The driver program sets it
+// before run_tests()
+std::size_t batch_records = 0;
+
+struct BatchSearch : TD_TestInput
+{
+	std::vector<std::string> patterns;
+	std::vector<std::string> texts;
+	std::vector<search_job> jobs;
+};
+struct Results : TD_TestOutput
+{
+	std::size_t matched;
+	std::size_t records;
+	std::chrono::microseconds elapsed;
+};
+
+TD_EXTEND
+struct Metrics : TD_TestMetricsBase
+{
+	TD_METRICS(Metrics)
+	{}
+
+	std::size_t match_count = 0;
+	std::size_t record_count = 0;
+	std::chrono::microseconds batch_elapsed{0};
+
+	void print_result() const
+	{
+		using namespace std;
+		if(!this->record_count && this->match_count) return;
+
+		cout << "  Search" << " Records..: " << this->record_count << '\n';
+		cout << "  Search" << " Matches..: " << this->match_count
+			 << " occurances\n";
+		cout << " Amortiz" << "ed Time...: " << ((1.0 * this->batch_elapsed.count()) / this->record_count)
+			 << " microseconds per record\n";
+	}
+
+	void reset()
+	{
+		this->match_count = 0;
+		this->record_count = 0;
+		this->batch_elapsed = std::chrono::microseconds(0);
+	}
+};
+
+std::size_t batch_boyermoore(const std::vector<search_job>& jobs)
+{
+	std::size_t matched = 0;
+	batch_search(jobs.empty() ? nullptr : &jobs[0], jobs.size(), [&matched](std::size_t, std::size_t) { ++matched; });
+	return matched;
+}
+
+/**
+ * Baseline: boyermoore_search() on each record in turn, preprocessing every time
+ */
+std::size_t boyermoore_each_record(const std::vector<search_job>& jobs)
+{
+	count_sink matches;
+	for(const search_job& job : jobs) boyermoore_search(*job.pattern, *job.text, matches);
+	return matches.count;
+}
+
+#define TD_USE_INPUT
+#define TD_USE_OUTPUT
+
+#include "TestDriver.h"
+
+TD_PREPARE_INPUT
+{
+	std::string pattern, text;
+	while((!batch_records || input->patterns.size() < batch_records) && read_corpus_record(TD_infile, pattern, text))
+	{
+		input->patterns.push_back(pattern);
+		input->texts.push_back(text);
+	}
+	// Jobs point into the vectors, so they are only made once both are complete
+	for(std::size_t record = 0; record < input->patterns.size(); ++record)
+	{
+		input->jobs.push_back({&input->patterns[record], &input->texts[record]});
+	}
+	return !input->jobs.empty();
+}
+
+TD_HANDLE_OUTPUT
+{
+	data->match_count += output->matched;
+	data->record_count += output->records;
+	data->batch_elapsed += output->elapsed;
+}
@@ -0,0 +1,28 @@
+//----------------------------------------------------------------------
+// FILE: batchperf.cpp
+// DESC: Driver program comparing the batch search API against calling
+//       Boyer-Moore once per record
+//----------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+#include <cstdlib>
+#include "batch_search_tests.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	if(argc > 3)
+	{
+		std::cerr << "usage: " << argv[0] << " [filename] [batch_records]" << std::endl;
+		return 1;
+	}
+	// Use default file if no input file given
+	string file(argc >= 2 ? argv[1] : "test_in.txt");
+	batch_records = argc == 3 ? atol(argv[2]) : 0;
+
+	TD_TestDriver td = TD_TestDriver("  Boyer-Moore (per record)", boyermoore_each_record);
+	td.add_test("       Batched Boyer-Moore", batch_boyermoore);
+	td.run_tests(file);
+}
@@ -7,25 +7,54 @@
 
 #include <string>
 #include <iostream>
+// Search engines come before the test configuration, since TestDriver defines macros
+// (input, output, data) that would clash with names in the headers they include
+#include "boyermoore.h"
+#include "naive_string_search.h"
+#include "horspool.h"
+#include "sunday.h"
+#include "bndm.h"
+#include "two_way.h"
+#include "search_dispatch.h"
 // Not reccomended to #include TestDriver here, can cause it to be improperly defined.
 // Instead, create a header file to handle the inlcude(s) and any configuration needed
 #include "search_tests_example.h"
-#include "boyermoore.h"
-#include "naive_string_search.h"
 
 using namespace std;
 
 int main(int argc, char* argv[])
 {
+	#ifdef TD_USE_OUTLIERS
+	if(argc > 3)
+	{
+		std::cerr << "usage: " << argv[0] << " [filename] [slowest_filename]" << std::endl;
+		return 1;
+	}
+	#else
 	if(argc > 2)
 	{
 		std::cerr << "usage: " << argv[0] << " [filename]" << std::endl;
 		return 1;
 	}
+	#endif
 	// Use default file if no input file given
-	string file(argc==2 ? argv[1] : "test_in.txt");
+	string file(argc>=2 ? argv[1] : "test_in.txt");
 
     TD_TestDriver td = TD_TestDriver(" Boyer-Moore String Search", boyermoore);
     td.add_test("       Naive String Search", naive_string_search);
+	td.add_test("    Horspool String Search", horspool);
+	td.add_test("      Sunday String Search", sunday);
+	td.add_test("        BNDM String Search", bndm);
+	td.add_test("     Two-Way String Search", two_way);
+	td.add_test("    Adaptive String Search", adaptive_string_search);
 	td.run_tests(file);
+	print_ranking();
+	#ifdef TD_USE_OUTLIERS
+	// Keep the slowest records of every function as a corpus of their own, for replay
+	if(argc == 3 && td.dump_slowest(argv[2]) < 0)
+	{
+		std::cerr << argv[0] << ": could not write " << argv[2] << std::endl;
+		return 1;
+	}
+	#endif
 }
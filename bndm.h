@@ -0,0 +1,92 @@
+//----------------------------------------------------------------------
+// FILE: bndm.h
+// DESC: Backward Nondeterministic DAWG Matching, a bit-parallel
+//       suffix automaton search for patterns up to 64 bytes
+//----------------------------------------------------------------------
+
+#ifndef BNDM_H
+#define BNDM_H
+
+#include <string>
+#include <list>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#include "match_sinks.h"
+
+// Longest pattern whose automaton fits in one machine word
+constexpr std::size_t BNDM_MAX_PATTERN = 64;
+
+/**
+ * BNDM search. Each alignment is read backwards while a bit-parallel simulation of the
+ * reversed pattern's suffix automaton tracks which pattern positions the characters read
+ * so far could end at. When the automaton dies the window is shifted to the last point a
+ * prefix of the pattern was seen, which skips more than the bad character rule whenever
+ * the pattern is long relative to the alphabet.
+ *
+ * The automaton holds one bit per pattern byte, so it is built for the first
+ * BNDM_MAX_PATTERN bytes only. Longer patterns are searched for by that prefix, and the
+ * rest of the pattern is compared with memcmp where the prefix matches.
+ *
+ * References
+ * - G. Navarro and M. Raffinot, "Fast and flexible string matching by combining
+ *   bit-parallelism and suffix automata", ACM J. Exp. Algorithmics 5, 2000
+ */
+template<typename Sink>
+bool bndm_search(const std::string& pattern, const std::string& text, Sink&& sink)
+{
+	const std::size_t text_length = text.length();
+	const std::size_t pattern_length = pattern.length();
+	if(text_length < pattern_length) return false;
+	if(pattern_length == 0) return true;
+
+	const unsigned char* pattern_bytes = reinterpret_cast<const unsigned char*>(pattern.c_str());
+	const unsigned char* text_bytes = reinterpret_cast<const unsigned char*>(text.c_str());
+	const std::size_t window = pattern_length < BNDM_MAX_PATTERN ? pattern_length : BNDM_MAX_PATTERN;
+
+	// Bit window-1-i of masks[c] is set when the pattern has c at position i, so bit
+	// window-1 of the state means the characters read so far are a prefix of the pattern
+	std::uint64_t masks[UCHAR_MAX + 1] = {};
+	for(std::size_t index = 0; index < window; ++index)
+	{
+		masks[pattern_bytes[index]] |= std::uint64_t(1) << (window - 1 - index);
+	}
+	const std::uint64_t prefix_bit = std::uint64_t(1) << (window - 1);
+	const std::uint64_t all_positions = prefix_bit | (prefix_bit - 1);
+
+	bool found = false;
+	for(std::size_t alignment = 0; alignment <= text_length - pattern_length;)
+	{
+		std::uint64_t state = all_positions;
+		std::size_t index = window;
+		std::size_t shift = window;
+		while(state && index)
+		{
+			--index;
+			state &= masks[text_bytes[alignment + index]];
+			if(state & prefix_bit)
+			{
+				if(index)
+				{
+					// A prefix of the pattern starts here; shift no further than this
+					shift = index;
+				} else if(!std::memcmp(pattern_bytes + window, text_bytes + alignment + window, pattern_length - window)) {
+					/***  MATCH  ***/
+					found = true;
+					if(!report_match(sink, alignment)) return true;
+				}
+			}
+			state <<= 1;
+		}
+		alignment += shift;
+	}
+	return found;
+}
+
+bool bndm(const std::string& pattern, const std::string& text, std::list<int>& matches)
+{
+	return bndm_search(pattern, text, list_sink{matches});
+}
+
+#endif
@@ -10,57 +10,131 @@
 #define BOYERMOORE_WITH_GALIL_IMPLEMENTATION
 #include <string>
 #include <list>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "match_sinks.h"
+#include "memory_placement.h"
 #include "naive_string_search.h"
+#include "td_phase.h"
 
-// Size of the character set, or alphabet, in this case the ASCII characters
-constexpr int CHARSET_LENGTH = 0x80;
+// Size of the character set, or alphabet, in this case every byte value. Characters are
+// always read as unsigned char so that text outside of ASCII indexes the tables safely
+constexpr int CHARSET_LENGTH = 0x100;
 
 /**
- * Boyer-Moore string-search algorithm implementation as a single function. For this
- * implementation, the Wikipedia article is being treated as if a proper specification,
- * EXCLUDING the "Implementations" article section
- * - https://en.wikipedia.org/wiki/Boyer%E2%80%93Moore_string-search_algorithm
- *
- * Information sources for the Apostolico-Giancarlo modifications
- * - https://en.wikipedia.org/wiki/Boyer%E2%80%93Moore_string-search_algorithm#Variants
- * - https://en.wikipedia.org/wiki/Apostolico%E2%80%93Giancarlo_algorithm
+ * Row-major table whose rows are indexed like a two dimensional array, so that
+ * table[row][column] reads the same as the fixed-size arrays the tables started out as
  */
-bool boyermoore(const std::string& pattern, const std::string& text, std::list<int>& matches)
+template<typename T, typename Row>
+class boyermoore_table
 {
-	// text_length is 'n' and pattern_length is 'm' from Wikipedia article's definitions of
-	// variables for the algorithim description
-	// - https://en.wikipedia.org/wiki/Boyer%E2%80%93Moore_string-search_algorithm#Definitions
-	const int text_length = text.length();
-	const int pattern_length = pattern.length();
-    const int pattern_end_index = pattern_length - 1;
-	// A string cannot contain a substring longer than the string itself
-	if(text_length < pattern_length) return false;
-	// Zero-width patterns trivially match any string
-	if(pattern_length == 0) return true;
-	if(text_length == 1)
+public:
+	void resize(std::size_t rows, std::size_t columns)
 	{
-		if(pattern[0] == text[0])
-		{
-			matches.push_back(0);
-			return true;
-		} else {
-			return false;
-		}
+		this->cells.assign(rows * columns, T());
+		this->columns = columns;
 	}
-	// If pattern_length == 1 it would probably be most effective to just call a naive
-	// search implementation since that is what will end up happening here in that case,
-	// just with more overhead
-	if(pattern_length == 1) return naive_string_search(pattern, text, matches);
-	// At this point, pattern_length is guaranteed to be >= 2, and text_length is
-	// guaranteed to be >= pattern_length. This is important for indexing safety
 
+	T* operator[](Row row)
+	{
+		return &this->cells[0] + row * this->columns;
+	}
 
-	/***  PREPROCESSING  ***/
+	const T* operator[](Row row) const
+	{
+		return &this->cells[0] + row * this->columns;
+	}
+private:
+	// Large tables can be placed on huge pages or a NUMA node, see memory_placement.h
+	std::vector<T, placement_allocator<T>> cells;
+	std::size_t columns = 0;
+};
+
+/**
+ * Preprocessed Boyer-Moore tables for a single pattern. This is the "PREPROCESSING" half
+ * of boyermoore(), kept separate so a pattern can be searched for in many texts, or in
+ * one text that arrives in pieces, while only being preprocessed once. Requires a
+ * pattern at least 2 characters long
+ */
+struct boyermoore_pattern
+{
+	explicit boyermoore_pattern(const std::string& pattern);
+
+	const unsigned char* bytes() const
+	{
+		return reinterpret_cast<const unsigned char*>(this->pattern.c_str());
+	}
+
+	std::string pattern;
+	int pattern_length;
+	boyermoore_table<int, unsigned char> bad_character_table;
+	std::vector<int> suffix_match_table;
+	std::vector<int> prefix_suffix_table;
+	boyermoore_table<char, int> skip_validation_table;
+};
+
+/**
+ * Storage for the Apostolico-Giancarlo table. A search only ever reads the entries for
+ * the pattern_length text positions under the current alignment, so instead of one entry
+ * per text character the entries live in a ring of at least pattern_length slots, and the
+ * slots a shift moves past are cleared as it happens. Positions are absolute offsets into
+ * the text, which lets one ring carry the table from one piece of a text to the next
+ */
+class apostolico_giancarlo_ring
+{
+public:
+	explicit apostolico_giancarlo_ring(int pattern_length)
+	{
+		std::size_t size = 1;
+		while(size < std::size_t(pattern_length)) size <<= 1;
+		this->slots.assign(size, 0);
+		this->mask = size - 1;
+	}
+
+	int& operator[](std::ptrdiff_t position)
+	{
+		return this->slots[(position + this->origin) & this->mask];
+	}
+
+	// Clears the entries of every position the alignment is about to move past
+	void advance(std::ptrdiff_t pattern_alignment_index, std::ptrdiff_t shift)
+	{
+		const std::ptrdiff_t cleared = shift < std::ptrdiff_t(this->slots.size()) ? shift : this->slots.size();
+		for(std::ptrdiff_t offset = 1; offset <= cleared; ++offset) (*this)[pattern_alignment_index + offset] = 0;
+	}
+
+	// Declares that index 0 of the text being scanned is at absolute offset position, for
+	// texts that are scanned in pieces
+	void rebase(std::uint64_t position)
+	{
+		this->origin = position & this->mask;
+	}
+
+	void reset()
+	{
+		this->slots.assign(this->slots.size(), 0);
+		this->origin = 0;
+	}
+private:
+	std::vector<int> slots;
+	std::size_t mask;
+	std::size_t origin = 0;
+};
+
+boyermoore_pattern::boyermoore_pattern(const std::string& pattern_string)
+: pattern(pattern_string)
+, pattern_length(pattern_string.length())
+{
+	const unsigned char* pattern = this->bytes();
+	const int pattern_end_index = pattern_length - 1;
+
+	TD_PHASE("bad_character_table");
 	/*
 	Bad Character rule
 	https://en.wikipedia.org/wiki/Boyer%E2%80%93Moore_string-search_algorithm#The_bad_character_rule
 	*/
-	int bad_character_table[CHARSET_LENGTH][pattern_length];
+	bad_character_table.resize(CHARSET_LENGTH, pattern_length);
 	for(int char_code = 0; char_code < CHARSET_LENGTH; ++char_code)
 	{
 		for(int pattern_index = 0; pattern_index < pattern_length; ++pattern_index)
@@ -121,14 +195,15 @@ bool boyermoore(const std::string& pattern, const std::string& text, std::list<i
 		}
 	}
 
+	TD_PHASE("good_suffix_tables");
 	/*
 	Good Suffix rule
 	https://en.wikipedia.org/wiki/Boyer%E2%80%93Moore_string-search_algorithm#The_good_suffix_rule
 	*/
 	// suffix_match_table is 'L' and prefix_suffix_table is 'H' from Wikipedia description
 	// https://en.wikipedia.org/wiki/Boyer%E2%80%93Moore_string-search_algorithm#Preprocessing_2
-	int suffix_match_table[pattern_length] = {};
-	int prefix_suffix_table[pattern_length] = {};
+	suffix_match_table.assign(pattern_length, 0);
+	prefix_suffix_table.assign(pattern_length, 0);
 	int suffix_search_offset;
 	suffix_match_table[pattern_length-1] = 0;
 	suffix_match_table[pattern_length-2] = 0;
@@ -177,8 +252,9 @@ bool boyermoore(const std::string& pattern, const std::string& text, std::list<i
 	// If only the last character in the pattern has been matched, the shift should be the
 	// distance to the next occurance of that character, which can be found in the
 	// bad_character_table, rather than defaulting to the value at the same index in
-	// the prefix_suffix_table
-	if(!suffix_match_table[pattern_length-2]) suffix_match_table[pattern_length-2] = bad_character_table[pattern[pattern_length-1]][pattern_length-2];
+	// the prefix_suffix_table. The table holds the distance from pattern_length-2, so one
+	// more is needed to reach the last character
+	if(!suffix_match_table[pattern_length-2]) suffix_match_table[pattern_length-2] = bad_character_table[pattern[pattern_length-1]][pattern_length-2] + 1;
 	// Initialize prefix_suffix_table
 	prefix_suffix_table[pattern_length-1] = pattern_length - (pattern[pattern_length-1] == pattern[0]);
 	for(int pattern_index = pattern_length-2; pattern_index > 0; --pattern_index )//prefix_suffix_table[pattern_index+1] = pattern_length - prefix_suffix_table[pattern_index+1], --pattern_index)
@@ -215,15 +291,16 @@ bool boyermoore(const std::string& pattern, const std::string& text, std::list<i
 	// value from index 1 is used, similar to the rest of table generation when a prefix
 	// suffix match is not found
 	prefix_suffix_table[0] = prefix_suffix_table[1];
-	// If the first character (the last character in the pattern) is a mismatch, always
-	// use the shift in bad_character_table
-	prefix_suffix_table[pattern_length-1] = 0;
 
+	TD_PHASE("skip_validation_table");
 	/*
 	Apostolico-Giancarlo
 	https://epubs.siam.org/doi/10.1137/0215007
 	*/
-	bool skip_validation_table[pattern_length][pattern_length];
+	// Where a skip runs past the start of the pattern, whether the remaining characters
+	// match is decided by prefix_suffix_table, so the table must still hold the prefix
+	// suffix match for the last character at this point
+	skip_validation_table.resize(pattern_length, pattern_length);
 	for(int pattern_index = 0; pattern_index < pattern_length; ++pattern_index)
 	{
 		for(int skip_length = 0; skip_length < pattern_length; ++skip_length)
@@ -241,14 +318,37 @@ bool boyermoore(const std::string& pattern, const std::string& text, std::list<i
 			}
 		}
 	}
-	/***  END PREPROCESSING  ***/
+	// If the first character (the last character in the pattern) is a mismatch, always
+	// use the shift in bad_character_table
+	prefix_suffix_table[pattern_length-1] = 0;
+}
 
+/**
+ * The "SEARCH" half of boyermoore(). Checks every alignment of the pattern from
+ * pattern_alignment_index (the text index of the last character of the pattern, k) up to
+ * the end of the text, reporting the index of the first character of each match, in
+ * order, to the match sink report. Returns the alignment index the search would continue
+ * from, which is always >= text_length, so that a search over a text arriving in pieces
+ * can resume in the next piece with the same apostolico_giancarlo_skip ring. If report
+ * stops the search, returns the alignment of the match it stopped at instead
+ */
+template<typename Report>
+std::ptrdiff_t boyermoore_scan(const boyermoore_pattern& compiled, apostolico_giancarlo_ring& apostolico_giancarlo_skip,
+	const char* text_chars, std::ptrdiff_t text_length, std::ptrdiff_t pattern_alignment_index, Report&& report)
+{
+	const unsigned char* text = reinterpret_cast<const unsigned char*>(text_chars);
+	const unsigned char* pattern = compiled.bytes();
+	const int pattern_length = compiled.pattern_length;
+	const int pattern_end_index = pattern_length - 1;
+	const auto& bad_character_table = compiled.bad_character_table;
+	const auto& suffix_match_table = compiled.suffix_match_table;
+	const auto& prefix_suffix_table = compiled.prefix_suffix_table;
+	const auto& skip_validation_table = compiled.skip_validation_table;
 
-	/***  SEARCH  ***/
 	// pattern_alignment_index is k from Wikipedia definitions
 	// https://en.wikipedia.org/wiki/Boyer%E2%80%93Moore_string-search_algorithm#Definitions
-	int pattern_alignment_index = pattern_end_index;
-	int pattern_index, pattern_alignment_start, bad_character_shift, good_suffix_shift, pattern_shift_length;
+	std::ptrdiff_t pattern_alignment_start;
+	int pattern_index, bad_character_shift, good_suffix_shift, pattern_shift_length;
 	/*
 	Apostolico-Giancarlo table
 	This table enables a generalization of the Galil rule, a significant optimization.
@@ -257,9 +357,9 @@ bool boyermoore(const std::string& pattern, const std::string& text, std::list<i
 	at that alignment. If text[k], text[k-1], and text[k-2] match the corresponding
 	characters pattern[pattern_length - 1], pattern[pattern_length - 2], and
 	pattern[pattern_length - 3], but the next character is a mismatch,
-	apostolico_giancarlo_skip[k] should be 3. Values at k-1 and k-2 don't change
+	apostolico_giancarlo_skip[k] should be 3. Values at k-1 and k-2 don't change.
+	See apostolico_giancarlo_ring for how the table is stored
 	*/
-	int apostolico_giancarlo_skip[text_length] = {};
 	while(pattern_alignment_index < text_length)
 	{
 		// pattern_alignment_start is analogous to index -1 from typical iteration contexts
@@ -275,6 +375,7 @@ bool boyermoore(const std::string& pattern, const std::string& text, std::list<i
 					good_suffix_shift = suffix_match_table[pattern_index];
 					if(!good_suffix_shift) good_suffix_shift = prefix_suffix_table[pattern_index];
 					pattern_shift_length = good_suffix_shift > bad_character_shift ? good_suffix_shift : bad_character_shift;
+					apostolico_giancarlo_skip.advance(pattern_alignment_index, pattern_shift_length);
 					pattern_alignment_index += pattern_shift_length;
 					break;
 				}
@@ -296,23 +397,91 @@ bool boyermoore(const std::string& pattern, const std::string& text, std::list<i
 			good_suffix_shift = suffix_match_table[pattern_index];
 			if(!good_suffix_shift) good_suffix_shift = prefix_suffix_table[pattern_index];
 			pattern_shift_length = good_suffix_shift > bad_character_shift ? good_suffix_shift : bad_character_shift;
+			apostolico_giancarlo_skip.advance(pattern_alignment_index, pattern_shift_length);
 			pattern_alignment_index += pattern_shift_length;
 			break;
 		}
 		if(pattern_index < 0)
 		{
 			/***  MATCH  ***/
-			matches.push_back(pattern_alignment_start);
+			if(!report_match(report, pattern_alignment_start)) return pattern_alignment_index;
 			pattern_shift_length = prefix_suffix_table[0];
 			apostolico_giancarlo_skip[pattern_alignment_index] = pattern_length - pattern_shift_length;
+			apostolico_giancarlo_skip.advance(pattern_alignment_index, pattern_shift_length);
 			pattern_alignment_index += pattern_shift_length;
 		}
 	}
+	return pattern_alignment_index;
+}
+
+/**
+ * Boyer-Moore string-search algorithm implementation as a single function, reporting
+ * matches to a match sink (see match_sinks.h). For this implementation, the Wikipedia
+ * article is being treated as if a proper specification, EXCLUDING the "Implementations"
+ * article section
+ * - https://en.wikipedia.org/wiki/Boyer%E2%80%93Moore_string-search_algorithm
+ *
+ * Information sources for the Apostolico-Giancarlo modifications
+ * - https://en.wikipedia.org/wiki/Boyer%E2%80%93Moore_string-search_algorithm#Variants
+ * - https://en.wikipedia.org/wiki/Apostolico%E2%80%93Giancarlo_algorithm
+ */
+template<typename Sink>
+bool boyermoore_search(const std::string& pattern, const std::string& text, Sink&& sink)
+{
+	// text_length is 'n' and pattern_length is 'm' from Wikipedia article's definitions of
+	// variables for the algorithim description
+	// - https://en.wikipedia.org/wiki/Boyer%E2%80%93Moore_string-search_algorithm#Definitions
+	const std::size_t text_length = text.length();
+	const std::size_t pattern_length = pattern.length();
+    const std::size_t pattern_end_index = pattern_length - 1;
+	// A string cannot contain a substring longer than the string itself
+	if(text_length < pattern_length) return false;
+	// Zero-width patterns trivially match any string
+	if(pattern_length == 0) return true;
+	if(text_length == 1)
+	{
+		if(pattern[0] == text[0])
+		{
+			report_match(sink, 0);
+			return true;
+		} else {
+			return false;
+		}
+	}
+	// If pattern_length == 1 it would probably be most effective to just call a naive
+	// search implementation since that is what will end up happening here in that case,
+	// just with more overhead
+	if(pattern_length == 1) return naive_search(pattern, text, sink);
+	// At this point, pattern_length is guaranteed to be >= 2, and text_length is
+	// guaranteed to be >= pattern_length. This is important for indexing safety
+
+
+
+	/***  PREPROCESSING  ***/
+	const boyermoore_pattern compiled(pattern);
+	/***  END PREPROCESSING  ***/
+
+
+	/***  SEARCH  ***/
+	TD_PHASE("search");
+	bool found = false;
+	apostolico_giancarlo_ring apostolico_giancarlo_skip(pattern_length);
+	boyermoore_scan(compiled, apostolico_giancarlo_skip, text.c_str(), text_length, pattern_end_index,
+		[&found, &sink](std::ptrdiff_t match) { found = true; return report_match(sink, match); });
 	/***  END SEARCH  ***/
 
 
-	// Convert truthy/falsy integer to a proper bool via !! idiom
-	return !!matches.size();
+	return found;
+}
+
+/**
+ * boyermoore_search() collecting matches into a std::list<int>. This is the signature the
+ * test drivers register; new code should prefer a match sink from match_sinks.h, which
+ * avoids a heap allocation per match and int offsets that overflow on texts over 2 GB
+ */
+bool boyermoore(const std::string& pattern, const std::string& text, std::list<int>& matches)
+{
+	return boyermoore_search(pattern, text, list_sink{matches});
 }
 
 #endif
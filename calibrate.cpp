@@ -0,0 +1,143 @@
+//----------------------------------------------------------------------
+// FILE: calibrate.cpp
+// DESC: Measures where the search engines cross over on this machine
+//       and writes the thresholds to a search_dispatch.h profile
+//----------------------------------------------------------------------
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+// Search engines come before the test configuration, since TestDriver defines macros
+// (input, output, data) that would clash with names in the headers they include
+#include "search_dispatch.h"
+#include "corpus_generator.h"
+#include "calibration_tests.h"
+
+using namespace std;
+
+// Records per generated corpus. Texts are long enough that one search takes far longer
+// than the microsecond resolution of the driver's timer
+const long RECORDS = 4;
+
+/**
+ * Runs the test driver over the corpus file with one function per engine, and returns the
+ * engine that took the least time in total
+ */
+search_engine fastest(const string& corpus, const vector<search_engine>& engines)
+{
+	auto header = [](search_engine engine)
+	{
+		const string name = search_engine_name(engine);
+		return string(name.length() < 12 ? 12 - name.length() : 0, ' ') + name;
+	};
+	TD_TestDriver td = TD_TestDriver(header(engines[0]), engine_function(engines[0]));
+	for(size_t engine = 1; engine < engines.size(); ++engine) td.add_test(header(engines[engine]), engine_function(engines[engine]));
+	calibration_elapsed.clear();
+	td.run_tests(corpus);
+
+	search_engine best = engines[0];
+	for(search_engine engine : engines)
+	{
+		if(calibration_elapsed[engine_function(engine)] < calibration_elapsed[engine_function(best)]) best = engine;
+	}
+	return best;
+}
+
+/**
+ * The last value in the run of values, from start, that engine won. Returns none if engine
+ * did not win at start; otherwise start is moved past the run
+ */
+size_t last_win(const vector<size_t>& values, const vector<search_engine>& winners, search_engine engine, size_t& start, size_t none)
+{
+	size_t last = none;
+	for(; start < values.size() && winners[start] == engine; ++start) last = values[start];
+	return last;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc > 3)
+	{
+		std::cerr << "usage: " << argv[0] << " [profile] [text_length]" << std::endl;
+		return 1;
+	}
+	const string profile_file(argc > 1 ? argv[1] : DEFAULT_SEARCH_PROFILE);
+	const long text_length = argc > 2 ? atol(argv[2]) : 1 << 20;
+	if(text_length < 1 << 16)
+	{
+		std::cerr << argv[0] << ": text_length must be at least " << (1 << 16) << std::endl;
+		return 1;
+	}
+	const string corpus = profile_file + ".corpus";
+	mt19937_64 rng(1);
+	search_profile profile;
+
+	// Pattern length over a large alphabet: naive search first, then Horspool, then
+	// Boyer-Moore as the patterns get long enough to pay for the good suffix tables
+	const vector<size_t> pattern_lengths = {2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128, 256};
+	vector<search_engine> winners;
+	for(size_t pattern_length : pattern_lengths)
+	{
+		ofstream out(corpus, ios::binary);
+		write_random_corpus(out, RECORDS, text_length, pattern_length, CORPUS_ALPHABET.length(), rng);
+		out.close();
+		winners.push_back(fastest(corpus, {search_engine::naive, search_engine::horspool, search_engine::boyermoore}));
+	}
+	size_t start = 0;
+	profile.naive_max_pattern = last_win(pattern_lengths, winners, search_engine::naive, start, 1);
+	profile.horspool_max_pattern = last_win(pattern_lengths, winners, search_engine::horspool, start, profile.naive_max_pattern);
+
+	// Alphabet size, for patterns long enough to contain the whole alphabet: Boyer-Moore
+	// while the bad character shifts are short, Horspool after
+	const vector<size_t> alphabet_sizes = {2, 3, 4, 6, 8, 12, 16, 24, 32};
+	winners.clear();
+	for(size_t alphabet_size : alphabet_sizes)
+	{
+		ofstream out(corpus, ios::binary);
+		write_random_corpus(out, RECORDS, text_length, 32, alphabet_size, rng);
+		out.close();
+		winners.push_back(fastest(corpus, {search_engine::horspool, search_engine::boyermoore}));
+	}
+	start = 0;
+	profile.boyermoore_max_distinct = last_win(alphabet_sizes, winners, search_engine::boyermoore, start, 0);
+
+	// Text length: naive search while preprocessing costs more than the search. The same
+	// amount of text is searched at every length, split over more records
+	const vector<size_t> text_lengths = {256, 512, 1024, 2048, 4096, 8192, 16384};
+	winners.clear();
+	for(size_t length : text_lengths)
+	{
+		ofstream out(corpus, ios::binary);
+		write_random_corpus(out, (RECORDS * text_length) / length, length, 8, 16, rng);
+		out.close();
+		winners.push_back(fastest(corpus, {search_engine::naive, search_engine::horspool, search_engine::boyermoore}));
+	}
+	start = 0;
+	profile.naive_max_text = last_win(text_lengths, winners, search_engine::naive, start, 0);
+
+	// Periodic patterns, which make naive search and Horspool quadratic
+	{
+		ofstream out(corpus, ios::binary);
+		write_periodic_corpus(out, RECORDS / 2, text_length, 32, 1);
+		write_periodic_corpus(out, RECORDS / 2, text_length, 32, 3);
+	}
+	profile.periodic_engine = fastest(corpus,
+		{search_engine::naive, search_engine::horspool, search_engine::boyermoore, search_engine::two_way});
+
+	remove(corpus.c_str());
+	if(!save_search_profile(profile_file, profile))
+	{
+		std::cerr << argv[0] << ": could not write " << profile_file << std::endl;
+		return 1;
+	}
+	cout << "Wrote " << profile_file << ":\n";
+	cout << "  naive_max_text..........: " << profile.naive_max_text << '\n';
+	cout << "  naive_max_pattern.......: " << profile.naive_max_pattern << '\n';
+	cout << "  boyermoore_max_distinct.: " << profile.boyermoore_max_distinct << '\n';
+	cout << "  horspool_max_pattern....: " << profile.horspool_max_pattern << '\n';
+	cout << "  periodic_engine.........: " << search_engine_name(profile.periodic_engine) << endl;
+}
@@ -0,0 +1,104 @@
+#include <string>
+#include <map>
+#include <chrono>
+#include <iostream>
+#include "test_driver_decls.h"
+#include "search_corpus.h"
+#include "match_sinks.h"
+#include "search_dispatch.h"
+
+// Harness configuration for calibrating the search dispatcher. Every function is one
+// engine forced through search_with(), and the time each takes is collected by function so
+// calibrate.cpp can compare engines after a run
+
+#define TD_ARGS input->pattern, input->text
+#define TD_RETURN_TO output->matched
+#define TD_POST_TIMER output->elapsed = time;
+#define TD_INPUT Search
+#define TD_OUTPUT Results
+#define TD_DATA Metrics
+
+using calibrated_function = std::size_t(*)(const std::string&, const std::string&);
+
+// Total time spent in each function under test. Cleared by the driver program between runs
+std::map<calibrated_function, std::chrono::microseconds> calibration_elapsed;
+
+struct Search : TD_TestInput
+{
+	std::string pattern;
+	std::string text;
+};
+struct Results : TD_TestOutput
+{
+	std::size_t matched;
+	std::chrono::microseconds elapsed;
+};
+
+TD_EXTEND
+struct Metrics : TD_TestMetricsBase
+{
+	TD_METRICS(Metrics)
+	, engine(f)
+	{}
+
+	calibrated_function engine;
+	std::size_t match_count = 0;
+	int success_count = 0;
+
+	void print_result() const
+	{
+		using namespace std;
+		if(!this->success_count && this->match_count) return;
+
+		cout << "  Search" << " Found....: " << this->success_count << '\n';
+		cout << "  Search" << " Matches..: " << this->match_count
+			 << " occurances\n";
+	}
+
+	void reset()
+	{
+		this->success_count = 0;
+		this->match_count = 0;
+	}
+};
+
+/**
+ * Counts the matches of pattern in text using ENGINE, whatever the dispatcher would pick
+ */
+template<search_engine ENGINE>
+std::size_t engine_count(const std::string& pattern, const std::string& text)
+{
+	count_sink matches;
+	search_with(ENGINE, pattern, text, matches);
+	return matches.count;
+}
+
+calibrated_function engine_function(search_engine engine)
+{
+	switch(engine)
+	{
+	case search_engine::memchr: return engine_count<search_engine::memchr>;
+	case search_engine::naive: return engine_count<search_engine::naive>;
+	case search_engine::horspool: return engine_count<search_engine::horspool>;
+	case search_engine::boyermoore: return engine_count<search_engine::boyermoore>;
+	case search_engine::two_way: return engine_count<search_engine::two_way>;
+	}
+	return nullptr;
+}
+
+#define TD_USE_INPUT
+#define TD_USE_OUTPUT
+
+#include "TestDriver.h"
+
+TD_PREPARE_INPUT
+{
+	return read_corpus_record(TD_infile, input->pattern, input->text);
+}
+
+TD_HANDLE_OUTPUT
+{
+	data->match_count += output->matched;
+	data->success_count += !!output->matched;
+	calibration_elapsed[data->engine] += output->elapsed;
+}
@@ -0,0 +1,251 @@
+//----------------------------------------------------------------------
+// FILE: caseless_search.h
+// DESC: ASCII case-insensitive Horspool and Boyer-Moore search, run on
+//       the original text with case folded in the shift tables and in
+//       a vectorized window compare
+//----------------------------------------------------------------------
+
+#ifndef CASELESS_SEARCH_H
+#define CASELESS_SEARCH_H
+
+#include <string>
+#include <list>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#include "match_sinks.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/*
+Case is folded for ASCII letters only; every other byte, UTF-8 included, has to match
+exactly. The pattern is folded once. The text is never copied: each shift table has an
+entry for every text byte, with both cases of a letter given the same shift, and windows
+are compared against the folded pattern by caseless_mismatch(), which folds 16 text bytes
+at a time with SSE2 (or 8 at a time in a 64-bit word without it).
+*/
+
+unsigned char ascii_fold(unsigned char c)
+{
+	return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+std::string ascii_fold(const std::string& text)
+{
+	std::string folded(text);
+	for(char& c : folded) c = ascii_fold((unsigned char)c);
+	return folded;
+}
+
+/**
+ * Compares window[0...length-1] with folded_pattern, folding the case of the window if
+ * FOLD is set, and returns the index of the last position that differs, or -1 if none does
+ */
+template<bool FOLD>
+std::ptrdiff_t window_mismatch(const unsigned char* window, const unsigned char* folded_pattern, std::ptrdiff_t length)
+{
+	std::ptrdiff_t end = length;
+	#ifdef __SSE2__
+	// From the end of the window, so that the block holding the last mismatch is found first
+	const __m128i bias = _mm_set1_epi8((char)(0x80 - 'A'));
+	const __m128i upper_limit = _mm_set1_epi8((char)(-0x80 + 26));
+	const __m128i case_bit = _mm_set1_epi8(0x20);
+	for(; end >= 16; end -= 16)
+	{
+		const __m128i text = _mm_loadu_si128(reinterpret_cast<const __m128i*>(window + end - 16));
+		// 'A'...'Z' move to the 26 smallest signed values
+		const __m128i upper = _mm_cmplt_epi8(_mm_add_epi8(text, bias), upper_limit);
+		const __m128i folded = FOLD ? _mm_or_si128(text, _mm_and_si128(upper, case_bit)) : text;
+		const __m128i pattern = _mm_loadu_si128(reinterpret_cast<const __m128i*>(folded_pattern + end - 16));
+		const unsigned differ = ~_mm_movemask_epi8(_mm_cmpeq_epi8(folded, pattern)) & 0xFFFF;
+		if(differ) return end - 16 + (31 - __builtin_clz(differ));
+	}
+	#else
+	for(; end >= 8; end -= 8)
+	{
+		std::uint64_t text, pattern;
+		std::memcpy(&text, window + end - 8, 8);
+		std::memcpy(&pattern, folded_pattern + end - 8, 8);
+		// The high bit of each byte of upper is set for 'A'...'Z': the low 7 bits are at
+		// least 'A' and below 'Z' + 1, and the byte itself is ASCII
+		const std::uint64_t low = text & 0x7F7F7F7F7F7F7F7Full;
+		const std::uint64_t at_least_a = low + 0x3F3F3F3F3F3F3F3Full;
+		const std::uint64_t past_z = low + 0x2525252525252525ull;
+		const std::uint64_t upper = at_least_a & ~past_z & ~text & 0x8080808080808080ull;
+		const std::uint64_t differ = (FOLD ? text | (upper >> 2) : text) ^ pattern;
+		if(!differ) continue;
+		// Bytes are in memory order, so the last byte that differs is the highest one on a
+		// little-endian machine and the lowest on a big-endian one
+		#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+		return end - 8 + (63 - __builtin_clzll(differ)) / 8;
+		#else
+		return end - 1 - __builtin_ctzll(differ) / 8;
+		#endif
+	}
+	#endif
+	while(end-- > 0)
+	{
+		if((FOLD ? ascii_fold(window[end]) : window[end]) != folded_pattern[end]) return end;
+	}
+	return -1;
+}
+
+std::ptrdiff_t caseless_mismatch(const unsigned char* window, const unsigned char* folded_pattern, std::ptrdiff_t length)
+{
+	return window_mismatch<true>(window, folded_pattern, length);
+}
+
+/**
+ * Case-insensitive Horspool search. Both cases of a letter get the shift of its folded
+ * form, and a window is compared only when the byte under the last pattern position
+ * matches the folded last pattern byte
+ */
+template<typename Sink>
+bool caseless_horspool_search(const std::string& pattern, const std::string& text, Sink&& sink)
+{
+	const std::size_t text_length = text.length();
+	const std::size_t pattern_length = pattern.length();
+	if(text_length < pattern_length) return false;
+	if(pattern_length == 0) return true;
+
+	const std::string folded_pattern = ascii_fold(pattern);
+	const unsigned char* pattern_bytes = reinterpret_cast<const unsigned char*>(folded_pattern.c_str());
+	const unsigned char* text_bytes = reinterpret_cast<const unsigned char*>(text.c_str());
+	const std::size_t pattern_end_index = pattern_length - 1;
+
+	std::size_t shift_table[UCHAR_MAX + 1];
+	for(auto& shift : shift_table) shift = pattern_length;
+	for(std::size_t index = 0; index < pattern_end_index; ++index)
+	{
+		shift_table[pattern_bytes[index]] = pattern_end_index - index;
+	}
+	for(int c = 'A'; c <= 'Z'; ++c) shift_table[c] = shift_table[c | 0x20];
+
+	bool found = false;
+	const unsigned char last = pattern_bytes[pattern_end_index];
+	for(std::size_t alignment = 0; alignment <= text_length - pattern_length;)
+	{
+		const unsigned char c = text_bytes[alignment + pattern_end_index];
+		if(ascii_fold(c) == last && caseless_mismatch(text_bytes + alignment, pattern_bytes, pattern_end_index) < 0)
+		{
+			/***  MATCH  ***/
+			found = true;
+			if(!report_match(sink, alignment)) break;
+		}
+		alignment += shift_table[c];
+	}
+	return found;
+}
+
+bool caseless_horspool(const std::string& pattern, const std::string& text, std::list<int>& matches)
+{
+	return caseless_horspool_search(pattern, text, list_sink{matches});
+}
+
+/**
+ * Boyer-Moore search, with the bad character rule (last occurance of each byte) and the
+ * good suffix rule. With FOLD set it is case-insensitive: both tables are built from the
+ * folded pattern, both cases of a letter get the same bad character shift, and windows are
+ * compared by caseless_mismatch(). Without it, the same search is exact, which is the
+ * baseline for searching a folded copy of the text. The whole window is compared at once,
+ * and the result is the rightmost mismatch the good suffix rule needs.
+ *
+ * Reference
+ * - C. Charras and T. Lecroq, "Handbook of Exact String Matching Algorithms", 2004,
+ *   chapter "Boyer-Moore algorithm"
+ */
+template<bool FOLD, typename Sink>
+bool window_boyermoore_search(const std::string& pattern, const std::string& text, Sink&& sink)
+{
+	const std::ptrdiff_t text_length = text.length();
+	const std::ptrdiff_t pattern_length = pattern.length();
+	if(text_length < pattern_length) return false;
+	if(pattern_length == 0) return true;
+
+	const std::string folded_pattern = FOLD ? ascii_fold(pattern) : pattern;
+	const unsigned char* pattern_bytes = reinterpret_cast<const unsigned char*>(folded_pattern.c_str());
+	const unsigned char* text_bytes = reinterpret_cast<const unsigned char*>(text.c_str());
+	const std::ptrdiff_t pattern_end_index = pattern_length - 1;
+
+	// Bad character rule: distance of each byte's last occurance from the end of the pattern
+	std::ptrdiff_t bad_character_table[UCHAR_MAX + 1];
+	for(auto& shift : bad_character_table) shift = pattern_length;
+	for(std::ptrdiff_t index = 0; index < pattern_end_index; ++index)
+	{
+		bad_character_table[pattern_bytes[index]] = pattern_end_index - index;
+	}
+	if(FOLD)
+	{
+		for(int c = 'A'; c <= 'Z'; ++c) bad_character_table[c] = bad_character_table[c | 0x20];
+	}
+
+	// Length of the longest suffix of pattern[0...i] that is also a suffix of the pattern
+	std::vector<std::ptrdiff_t> suffixes(pattern_length);
+	suffixes[pattern_end_index] = pattern_length;
+	std::ptrdiff_t start = pattern_end_index, end = pattern_end_index;
+	for(std::ptrdiff_t index = pattern_end_index - 1; index >= 0; --index)
+	{
+		if(index > start && suffixes[index + pattern_end_index - end] < index - start)
+		{
+			suffixes[index] = suffixes[index + pattern_end_index - end];
+			continue;
+		}
+		if(index < start) start = index;
+		end = index;
+		while(start >= 0 && pattern_bytes[start] == pattern_bytes[start + pattern_end_index - end]) --start;
+		suffixes[index] = end - start;
+	}
+
+	// Good suffix rule: shift after a mismatch at each pattern position
+	std::vector<std::ptrdiff_t> good_suffix_table(pattern_length, pattern_length);
+	std::ptrdiff_t next = 0;
+	for(std::ptrdiff_t index = pattern_end_index; index >= 0; --index)
+	{
+		if(suffixes[index] != index + 1) continue;
+		for(; next < pattern_end_index - index; ++next)
+		{
+			if(good_suffix_table[next] == pattern_length) good_suffix_table[next] = pattern_end_index - index;
+		}
+	}
+	for(std::ptrdiff_t index = 0; index < pattern_end_index; ++index)
+	{
+		good_suffix_table[pattern_end_index - suffixes[index]] = pattern_end_index - index;
+	}
+
+	bool found = false;
+	for(std::ptrdiff_t alignment = 0; alignment <= text_length - pattern_length;)
+	{
+		const std::ptrdiff_t index = window_mismatch<FOLD>(text_bytes + alignment, pattern_bytes, pattern_length);
+		if(index < 0)
+		{
+			/***  MATCH  ***/
+			found = true;
+			if(!report_match(sink, alignment)) break;
+			alignment += good_suffix_table[0];
+			continue;
+		}
+		const std::ptrdiff_t bad_character_shift = bad_character_table[text_bytes[alignment + index]] - (pattern_end_index - index);
+		const std::ptrdiff_t good_suffix_shift = good_suffix_table[index];
+		alignment += good_suffix_shift > bad_character_shift ? good_suffix_shift : bad_character_shift;
+	}
+	return found;
+}
+
+/**
+ * Case-insensitive Boyer-Moore search on the original text, see window_boyermoore_search()
+ */
+template<typename Sink>
+bool caseless_boyermoore_search(const std::string& pattern, const std::string& text, Sink&& sink)
+{
+	return window_boyermoore_search<true>(pattern, text, sink);
+}
+
+bool caseless_boyermoore(const std::string& pattern, const std::string& text, std::list<int>& matches)
+{
+	return caseless_boyermoore_search(pattern, text, list_sink{matches});
+}
+
+#endif
@@ -0,0 +1,62 @@
+//----------------------------------------------------------------------
+// FILE: caseperf.cpp
+// DESC: Driver program comparing case-insensitive search on the
+//       original text against lowercasing a copy of it first
+//----------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+// Search engines come before the test configuration, since TestDriver defines macros
+// (input, output, data) that would clash with names in the headers they include
+#include "horspool.h"
+#include "caseless_search.h"
+#include "sink_search_tests.h"
+
+using namespace std;
+
+// The approach the caseless engines replace: fold a copy of the text, then search it with
+// the same engine doing exact comparisons, so that only the cost of the copy differs
+std::size_t copy_fold_boyermoore(const std::string& pattern, const std::string& text)
+{
+	count_sink matches;
+	window_boyermoore_search<false>(ascii_fold(pattern), ascii_fold(text), matches);
+	return matches.count;
+}
+
+std::size_t copy_fold_horspool(const std::string& pattern, const std::string& text)
+{
+	count_sink matches;
+	horspool_search(ascii_fold(pattern), ascii_fold(text), matches);
+	return matches.count;
+}
+
+std::size_t caseless_boyermoore_count(const std::string& pattern, const std::string& text)
+{
+	count_sink matches;
+	caseless_boyermoore_search(pattern, text, matches);
+	return matches.count;
+}
+
+std::size_t caseless_horspool_count(const std::string& pattern, const std::string& text)
+{
+	count_sink matches;
+	caseless_horspool_search(pattern, text, matches);
+	return matches.count;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc > 2)
+	{
+		std::cerr << "usage: " << argv[0] << " [filename]" << std::endl;
+		return 1;
+	}
+	// Use default file if no input file given
+	string file(argc==2 ? argv[1] : "test_in.txt");
+
+	TD_TestDriver td = TD_TestDriver(" Boyer-Moore (folded copy)", copy_fold_boyermoore);
+	td.add_test("      Caseless Boyer-Moore", caseless_boyermoore_count);
+	td.add_test("    Horspool (folded copy)", copy_fold_horspool);
+	td.add_test("         Caseless Horspool", caseless_horspool_count);
+	td.run_tests(file);
+}
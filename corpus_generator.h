@@ -0,0 +1,51 @@
+//----------------------------------------------------------------------
+// FILE: corpus_generator.h
+// DESC: Synthetic search corpora, written in the search_corpus.h format
+//----------------------------------------------------------------------
+
+#ifndef CORPUS_GENERATOR_H
+#define CORPUS_GENERATOR_H
+
+#include <string>
+#include <ostream>
+#include <random>
+#include "search_corpus.h"
+
+// Random texts are drawn from the first alphabet_size characters of this set
+const std::string CORPUS_ALPHABET = "etaoinshrdlcumwfgypbvkjxqz ETAOINSHRDLCUMWFGYPBVKJXQZ0123456789";
+
+/**
+ * Writes records of uniformly random text over the first alphabet_size characters of
+ * CORPUS_ALPHABET. Patterns are cut from the text, so every record has at least one match.
+ * Requires 0 < pattern_length <= text_length and 0 < alphabet_size <= CORPUS_ALPHABET.length()
+ */
+void write_random_corpus(std::ostream& out, long records, long text_length, long pattern_length, long alphabet_size, std::mt19937_64& rng)
+{
+	std::uniform_int_distribution<long> character(0, alphabet_size - 1);
+	std::uniform_int_distribution<long> position(0, text_length - pattern_length);
+	std::string text(text_length, '\0');
+	for(long record = 0; record < records; ++record)
+	{
+		for(auto& c : text) c = CORPUS_ALPHABET[character(rng)];
+		write_corpus_field(out, text.substr(position(rng), pattern_length));
+		write_corpus_field(out, text);
+	}
+}
+
+/**
+ * Writes records whose text and pattern both repeat the first period characters of
+ * CORPUS_ALPHABET, so the pattern matches at every period'th position. With period 1 that
+ * is a^m searched for in a^n
+ */
+void write_periodic_corpus(std::ostream& out, long records, long text_length, long pattern_length, long period)
+{
+	std::string text(text_length, '\0');
+	for(long index = 0; index < text_length; ++index) text[index] = CORPUS_ALPHABET[index % period];
+	for(long record = 0; record < records; ++record)
+	{
+		write_corpus_field(out, text.substr(0, pattern_length));
+		write_corpus_field(out, text);
+	}
+}
+
+#endif
@@ -0,0 +1,59 @@
+//----------------------------------------------------------------------
+// FILE: corpusgen.cpp
+// DESC: Writes synthetic search corpora in the test_in.txt format
+//----------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <cstdlib>
+#include <cstring>
+#include "search_corpus.h"
+#include "corpus_generator.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	// -a writes adversarial records instead: texts of all 'a', searched for a^(m-1)b and a^m,
+	// which make a naive search compare every pattern character at every alignment
+	const char* program = argv[0];
+	const bool adversarial = argc > 1 && !strcmp(argv[1], "-a");
+	if(adversarial)
+	{
+		--argc;
+		++argv;
+	}
+	if(argc < 5 || argc > 7)
+	{
+		std::cerr << "usage: " << program << " [-a] filename records text_length pattern_length [alphabet_size] [seed]" << std::endl;
+		return 1;
+	}
+	const long records = atol(argv[2]);
+	const long text_length = atol(argv[3]);
+	const long pattern_length = atol(argv[4]);
+	const long alphabet_size = argc > 5 ? atol(argv[5]) : 4;
+	mt19937_64 rng(argc > 6 ? atol(argv[6]) : 1);
+	if(records <= 0 || text_length <= 0 || pattern_length <= 0 || pattern_length > text_length
+		|| alphabet_size <= 0 || alphabet_size > long(CORPUS_ALPHABET.length()))
+	{
+		std::cerr << program << ": invalid sizes" << std::endl;
+		return 1;
+	}
+
+	ofstream out(argv[1], ios::binary);
+	if(!adversarial)
+	{
+		write_random_corpus(out, records, text_length, pattern_length, alphabet_size, rng);
+		return out ? 0 : 1;
+	}
+	for(long record = 0; record < records; ++record)
+	{
+		string pattern(pattern_length, 'a');
+		if(record % 2 == 0) pattern.back() = 'b';
+		write_corpus_field(out, pattern);
+		write_corpus_field(out, string(text_length, 'a'));
+	}
+	return out ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+//----------------------------------------------------------------------
+// FILE: horspool.h
+// DESC: Boyer-Moore-Horspool string search, the bad character rule on
+//       its own, keyed on the text character under the last position
+//       of the pattern
+//----------------------------------------------------------------------
+
+#ifndef HORSPOOL_H
+#define HORSPOOL_H
+
+#include <string>
+#include <list>
+#include <cstddef>
+#include <cstring>
+#include <climits>
+#include "match_sinks.h"
+
+/**
+ * Horspool search. The shift after every alignment is how far the text character under the
+ * last pattern position is from its last occurance in pattern[0...m-2], or m if it is not
+ * there. One table of UCHAR_MAX + 1 entries and no good suffix rule makes preprocessing
+ * cheap, which pays off on short patterns over large alphabets where the shifts are long
+ * anyway.
+ *
+ * References
+ * - R. N. Horspool, "Practical fast searching in strings", Software: Practice and
+ *   Experience 10(6), 1980
+ * - https://en.wikipedia.org/wiki/Boyer%E2%80%93Moore%E2%80%93Horspool_algorithm
+ */
+template<typename Sink>
+bool horspool_search(const std::string& pattern, const std::string& text, Sink&& sink)
+{
+	const std::size_t text_length = text.length();
+	const std::size_t pattern_length = pattern.length();
+	if(text_length < pattern_length) return false;
+	if(pattern_length == 0) return true;
+
+	const unsigned char* pattern_bytes = reinterpret_cast<const unsigned char*>(pattern.c_str());
+	const unsigned char* text_bytes = reinterpret_cast<const unsigned char*>(text.c_str());
+	const std::size_t pattern_end_index = pattern_length - 1;
+
+	std::size_t shift_table[UCHAR_MAX + 1];
+	for(auto& shift : shift_table) shift = pattern_length;
+	for(std::size_t index = 0; index < pattern_end_index; ++index)
+	{
+		shift_table[pattern_bytes[index]] = pattern_end_index - index;
+	}
+
+	bool found = false;
+	const unsigned char last = pattern_bytes[pattern_end_index];
+	for(std::size_t alignment = 0; alignment <= text_length - pattern_length;)
+	{
+		const unsigned char c = text_bytes[alignment + pattern_end_index];
+		if(c == last && !std::memcmp(pattern_bytes, text_bytes + alignment, pattern_end_index))
+		{
+			/***  MATCH  ***/
+			found = true;
+			if(!report_match(sink, alignment)) break;
+		}
+		alignment += shift_table[c];
+	}
+	return found;
+}
+
+bool horspool(const std::string& pattern, const std::string& text, std::list<int>& matches)
+{
+	return horspool_search(pattern, text, list_sink{matches});
+}
+
+#endif
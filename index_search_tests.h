@@ -0,0 +1,200 @@
+#include <string>
+#include <list>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <unordered_map>
+#include "test_driver_decls.h"
+#include "search_corpus.h"
+#include "boyermoore.h"
+#include "suffix_array_index.h"
+
+// Harness configuration for text indexes. Indexes are built (or mapped from disk) once per
+// distinct text when the corpus is loaded, outside of the timed region, so the driver only
+// times queries. What the indexes cost to get is collected in index_costs instead
+
+#define TD_ARGS *input->index, input->pattern, *input->text, input->matches
+#define TD_RETURN_TO output->success
+#define TD_PRE_TIMER input->matches.clear();
+#define TD_POST_TIMER output->matched = input->matches.size();
+#define TD_INPUT IndexSearch
+#define TD_OUTPUT Results
+#define TD_DATA Metrics
+
+// When set, the index of the i'th distinct text is kept in <index_file_prefix>.<i>. Files
+// that hold an index of the same text are mapped instead of building it again
+std::string index_file_prefix;
+
+struct index_build_costs
+{
+	std::chrono::microseconds build_elapsed{0};
+	std::chrono::microseconds map_elapsed{0};
+	std::size_t built = 0;
+	std::size_t mapped = 0;
+	std::size_t memory_bytes = 0;
+};
+index_build_costs index_costs;
+
+struct IndexSearch : TD_TestInput
+{
+	const suffix_array_index* index;
+	const std::string* text;
+	std::string pattern;
+	std::list<int> matches;
+};
+struct Results : TD_TestOutput
+{
+	bool success;
+	int matched;
+};
+
+TD_EXTEND
+struct Metrics : TD_TestMetricsBase
+{
+	TD_METRICS(Metrics)
+	{}
+
+	int match_count = 0;
+	int success_count = 0;
+
+	void print_result() const
+	{
+		using namespace std;
+		if(!this->success_count && this->match_count) return;
+
+		cout << "  Search" << " Found....: " << this->success_count << '\n';
+		cout << "  Search" << " Matches..: " << this->match_count
+			 << " occurances\n";
+		cout << " Average" << " Matches..: " << ((1.0 * this->match_count) / this->success_count)
+			 << " occurances\n";
+	}
+
+	void reset()
+	{
+		this->success_count = 0;
+		this->match_count = 0;
+	}
+};
+
+bool suffix_array_query(const suffix_array_index& index, const std::string& pattern, const std::string&, std::list<int>& matches)
+{
+	return index.search(pattern, list_sink{matches});
+}
+
+/**
+ * Baseline: ignores the index and scans the text
+ */
+bool boyermoore_scan_text(const suffix_array_index&, const std::string& pattern, const std::string& text, std::list<int>& matches)
+{
+	return boyermoore(pattern, text, matches);
+}
+
+/**
+ * Maps the index saved in filename, if there is one and it is an index of text. Returns
+ * nullptr otherwise
+ */
+std::unique_ptr<suffix_array_index> map_text_index(const std::string& text, const std::string& filename, index_build_costs& costs)
+{
+	using namespace std::chrono;
+	if(!filename.empty())
+	{
+		const auto start = steady_clock::now();
+		std::unique_ptr<suffix_array_index> index = suffix_array_index::map(filename);
+		if(index && index->text_length() == text.length() && !text.compare(0, text.length(), index->text(), index->text_length()))
+		{
+			costs.map_elapsed += duration_cast<microseconds>(steady_clock::now() - start);
+			++costs.mapped;
+			return index;
+		}
+	}
+	return nullptr;
+}
+
+void print_index_costs(const index_build_costs& costs)
+{
+	using namespace std;
+	cout << "\n Index Costs\n============\n\n";
+	cout << "  Index" << " Built......: " << costs.built << " in " << costs.build_elapsed.count() << " microseconds\n";
+	cout << "  Index" << " Mapped.....: " << costs.mapped << " in " << costs.map_elapsed.count() << " microseconds\n";
+	cout << "  Index" << " Memory.....: " << costs.memory_bytes << " bytes\n" << endl;
+}
+
+#define TD_USE_INPUT
+#define TD_USE_OUTPUT
+
+#include "TestDriver.h"
+
+// The whole corpus is read on the first call, so that the indexes of all the distinct texts
+// can be built together on a thread pool, then one record is handed out per call. State is
+// dropped at the end so the next run_tests() starts over
+TD_PREPARE_INPUT
+{
+	using namespace std::chrono;
+	static std::vector<std::string> texts;
+	static std::vector<std::pair<std::string, std::size_t>> records;
+	static std::vector<std::unique_ptr<suffix_array_index>> indexes;
+	static std::size_t next_record = 0;
+
+	if(indexes.empty() && records.empty())
+	{
+		// Position of each distinct text in texts
+		std::unordered_map<std::string, std::size_t> text_positions;
+		std::string pattern, text;
+		while(read_corpus_record(TD_infile, pattern, text))
+		{
+			const auto position = text_positions.emplace(text, texts.size());
+			if(position.second) texts.push_back(text);
+			records.emplace_back(pattern, position.first->second);
+		}
+		// The stream hit end of file above, but the driver keeps calling while it is good
+		TD_infile.clear();
+
+		indexes.resize(texts.size());
+		std::vector<std::string> unmapped;
+		std::vector<std::size_t> unmapped_index;
+		for(std::size_t which = 0; which < texts.size(); ++which)
+		{
+			const std::string filename = index_file_prefix.empty() ? "" : index_file_prefix + '.' + std::to_string(which);
+			indexes[which] = map_text_index(texts[which], filename, index_costs);
+			if(indexes[which]) continue;
+			unmapped.push_back(texts[which]);
+			unmapped_index.push_back(which);
+		}
+		if(!unmapped.empty())
+		{
+			static search_thread_pool pool;
+			const auto start = steady_clock::now();
+			std::vector<std::unique_ptr<suffix_array_index>> built = build_suffix_array_indexes(unmapped, pool);
+			index_costs.build_elapsed += duration_cast<microseconds>(steady_clock::now() - start);
+			index_costs.built += built.size();
+			for(std::size_t which = 0; which < built.size(); ++which)
+			{
+				if(!index_file_prefix.empty()) built[which]->save(index_file_prefix + '.' + std::to_string(unmapped_index[which]));
+				indexes[unmapped_index[which]] = std::move(built[which]);
+			}
+		}
+		for(const auto& index : indexes) index_costs.memory_bytes += index->memory_bytes();
+	}
+	if(next_record == records.size())
+	{
+		texts.clear();
+		records.clear();
+		indexes.clear();
+		next_record = 0;
+		return false;
+	}
+
+	const std::size_t which = records[next_record].second;
+	input->index = indexes[which].get();
+	input->text = &texts[which];
+	input->pattern = records[next_record++].first;
+	return true;
+}
+
+TD_HANDLE_OUTPUT
+{
+	data->match_count += output->matched;
+	data->success_count += output->success;
+}
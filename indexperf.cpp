@@ -0,0 +1,37 @@
+//----------------------------------------------------------------------
+// FILE: indexperf.cpp
+// DESC: Driver program comparing suffix array queries against scanning
+//       the text with Boyer-Moore for every pattern
+//----------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+#include <stdexcept>
+#include "index_search_tests.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	if(argc > 3)
+	{
+		std::cerr << "usage: " << argv[0] << " [filename] [index_file_prefix]" << std::endl;
+		return 1;
+	}
+	// Use default file if no input file given
+	string file(argc >= 2 ? argv[1] : "test_in.txt");
+	if(argc == 3) index_file_prefix = argv[2];
+
+	TD_TestDriver td = TD_TestDriver(" Boyer-Moore (text scan)", boyermoore_scan_text);
+	td.add_test("    Suffix Array (SA-IS)", suffix_array_query);
+	try
+	{
+		td.run_tests(file);
+	}
+	catch(const std::length_error& error)
+	{
+		std::cerr << argv[0] << ": " << error.what() << std::endl;
+		return 1;
+	}
+	print_index_costs(index_costs);
+}
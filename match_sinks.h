@@ -0,0 +1,119 @@
+//----------------------------------------------------------------------
+// FILE: match_sinks.h
+// DESC: Destinations for the matches found by the search engines
+//----------------------------------------------------------------------
+
+#ifndef MATCH_SINKS_H
+#define MATCH_SINKS_H
+
+#include <list>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+/*
+A match sink is anything callable as sink(offset) with the offset of the first character
+of a match. Engines call it once per match, in increasing offset order. If it returns
+false the search stops there; sinks that return void never stop the search, so a plain
+lambda can be used as a sink directly.
+*/
+
+/**
+ * Passes one match to a sink, returning false if the search should stop
+ */
+template<typename Sink>
+bool report_match(Sink&& sink, std::size_t offset)
+{
+	if constexpr(std::is_void_v<decltype(sink(offset))>)
+	{
+		sink(offset);
+		return true;
+	} else {
+		return sink(offset);
+	}
+}
+
+/**
+ * Appends matches to a caller-owned vector. The vector is not cleared, so a caller that
+ * clear()s and reuses the same vector only allocates until its capacity settles
+ */
+struct vector_sink
+{
+	explicit vector_sink(std::vector<std::size_t>& matches, std::size_t expected = 0)
+	: matches(matches)
+	{
+		matches.reserve(matches.size() + expected);
+	}
+
+	bool operator()(std::size_t offset)
+	{
+		this->matches.push_back(offset);
+		return true;
+	}
+
+	std::vector<std::size_t>& matches;
+};
+
+/**
+ * Counts matches without storing them
+ */
+struct count_sink
+{
+	bool operator()(std::size_t)
+	{
+		++this->count;
+		return true;
+	}
+
+	std::size_t count = 0;
+};
+
+/**
+ * Keeps the first match and stops the search, for existence checks
+ */
+struct first_match_sink
+{
+	bool operator()(std::size_t offset)
+	{
+		this->found = true;
+		this->offset = offset;
+		return false;
+	}
+
+	bool found = false;
+	std::size_t offset = 0;
+};
+
+/**
+ * Calls f(offset) for every match. Holding the callable by type rather than through
+ * std::function lets the compiler inline it into the search loop
+ */
+template<typename F>
+struct callback_sink
+{
+	bool operator()(std::size_t offset)
+	{
+		this->f(offset);
+		return true;
+	}
+
+	F f;
+};
+template<typename F>
+callback_sink(F) -> callback_sink<F>;
+
+/**
+ * Appends matches to a std::list<int>, for the original boyermoore() signature
+ */
+struct list_sink
+{
+	bool operator()(std::size_t offset)
+	{
+		this->matches.push_back(offset);
+		return true;
+	}
+
+	std::list<int>& matches;
+};
+
+#endif
@@ -0,0 +1,235 @@
+//----------------------------------------------------------------------
+// FILE: memory_placement.h
+// DESC: Memory on huge pages and bound to a NUMA node, for search
+//       texts and the tables of the search engines
+//----------------------------------------------------------------------
+
+#ifndef MEMORY_PLACEMENT_H
+#define MEMORY_PLACEMENT_H
+
+#include <string>
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*
+A placement asks for a page size and, optionally, a NUMA node. Each request falls back to
+what the system can do, and the placement granted is returned so it can be reported:
+- explicit huge pages are 2 MB pages from the hugetlbfs pool (MAP_HUGETLB), which is empty
+  unless vm.nr_hugepages has been raised; without them the request becomes
+- transparent huge pages, an ordinary mapping marked with madvise(MADV_HUGEPAGE), which the
+  kernel backs with 2 MB pages where it can; without THP support the request becomes
+- standard pages
+A node is bound with mbind(MPOL_BIND) before the memory is first touched, so every page is
+allocated on that node. The binding is dropped if the kernel has no NUMA support or no such
+node. mbind is called through syscall(), so libnuma is not needed.
+*/
+
+enum class page_size_policy
+{
+	standard,
+	transparent_huge,
+	explicit_huge
+};
+
+constexpr std::size_t HUGE_PAGE_BYTES = 2 << 20;
+
+struct memory_placement
+{
+	page_size_policy pages = page_size_policy::standard;
+	// NUMA node the memory is bound to, or -1 for wherever the kernel puts it
+	int numa_node = -1;
+};
+
+bool operator==(const memory_placement& left, const memory_placement& right)
+{
+	return left.pages == right.pages && left.numa_node == right.numa_node;
+}
+
+const char* page_size_policy_name(page_size_policy pages)
+{
+	switch(pages)
+	{
+		case page_size_policy::transparent_huge: return "transparent huge pages";
+		case page_size_policy::explicit_huge: return "explicit 2 MB huge pages";
+		default: return "standard pages";
+	}
+}
+
+std::string describe_placement(const memory_placement& placement)
+{
+	return std::string(page_size_policy_name(placement.pages))
+		+ (placement.numa_node < 0 ? ", any node" : ", node " + std::to_string(placement.numa_node));
+}
+
+/**
+ * A mapping made by place_memory(), and the placement it was given
+ */
+struct placed_region
+{
+	void* address = nullptr;
+	std::size_t length = 0;
+	memory_placement granted;
+};
+
+/**
+ * Maps at least bytes of memory placed as close to requested as the system allows. The
+ * region's address is nullptr if nothing could be mapped at all
+ */
+placed_region place_memory(std::size_t bytes, const memory_placement& requested)
+{
+	placed_region region;
+	if(!bytes) bytes = 1;
+	const std::size_t huge_length = (bytes + HUGE_PAGE_BYTES - 1) / HUGE_PAGE_BYTES * HUGE_PAGE_BYTES;
+
+	#ifdef MAP_HUGETLB
+	if(requested.pages == page_size_policy::explicit_huge)
+	{
+		void* address = mmap(nullptr, huge_length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if(address != MAP_FAILED)
+		{
+			region.address = address;
+			region.length = huge_length;
+			region.granted.pages = page_size_policy::explicit_huge;
+		}
+	}
+	#endif
+	if(!region.address)
+	{
+		const bool huge = requested.pages != page_size_policy::standard;
+		const std::size_t length = huge ? huge_length : bytes;
+		void* address = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(address == MAP_FAILED) return placed_region();
+		region.address = address;
+		region.length = length;
+		#ifdef MADV_HUGEPAGE
+		if(huge && !madvise(address, length, MADV_HUGEPAGE)) region.granted.pages = page_size_policy::transparent_huge;
+		#endif
+	}
+
+	#ifdef SYS_mbind
+	if(requested.numa_node >= 0 && requested.numa_node < 64)
+	{
+		// MPOL_BIND from <numaif.h>
+		constexpr int bind_policy = 2;
+		const unsigned long node_mask = 1ul << requested.numa_node;
+		// The kernel reads maxnode - 1 bits of the mask, so all 64 bits take a maxnode of 65
+		if(!syscall(SYS_mbind, region.address, region.length, bind_policy, &node_mask, 65ul, 0u))
+		{
+			region.granted.numa_node = requested.numa_node;
+		}
+	}
+	#endif
+	return region;
+}
+
+void release_memory(const placed_region& region)
+{
+	if(region.address) munmap(region.address, region.length);
+}
+
+/**
+ * How many regions were given each placement, for reports
+ */
+struct placement_tally
+{
+	void add(const memory_placement& granted)
+	{
+		++this->regions[static_cast<int>(granted.pages)];
+		if(granted.numa_node >= 0) ++this->bound;
+	}
+
+	void reset()
+	{
+		for(auto& count : this->regions) count = 0;
+		this->bound = 0;
+	}
+
+	std::string describe() const
+	{
+		std::string description;
+		for(int pages = 0; pages < 3; ++pages)
+		{
+			if(!this->regions[pages]) continue;
+			if(!description.empty()) description += ", ";
+			description += std::to_string(this->regions[pages]) + " on " + page_size_policy_name(static_cast<page_size_policy>(pages));
+		}
+		if(description.empty()) return "none";
+		return description + " (" + std::to_string(this->bound) + " bound to the node)";
+	}
+
+	std::atomic<long> regions[3] = {};
+	std::atomic<long> bound{0};
+};
+
+// Placement of engine tables of at least PLACEMENT_MIN_BYTES, and what they were given.
+// Smaller tables, and all of them while the placement is the default, come from the heap
+inline memory_placement engine_table_placement;
+inline placement_tally engine_table_tally;
+constexpr std::size_t PLACEMENT_MIN_BYTES = 64 << 10;
+
+/**
+ * Allocator for engine tables, placing the large ones by engine_table_placement
+ */
+template<typename T>
+struct placement_allocator
+{
+	using value_type = T;
+
+	placement_allocator() = default;
+	template<typename U>
+	placement_allocator(const placement_allocator<U>&)
+	{}
+
+	T* allocate(std::size_t count)
+	{
+		// A header in front of the table records how it was allocated, so it can be freed
+		// the same way even if the placement changes in the meantime
+		const std::size_t bytes = HEADER_BYTES + count * sizeof(T);
+		char* block;
+		if(bytes < PLACEMENT_MIN_BYTES || engine_table_placement == memory_placement())
+		{
+			block = static_cast<char*>(::operator new(bytes));
+			*reinterpret_cast<std::size_t*>(block) = 0;
+		} else {
+			const placed_region region = place_memory(bytes, engine_table_placement);
+			if(!region.address) throw std::bad_alloc();
+			engine_table_tally.add(region.granted);
+			block = static_cast<char*>(region.address);
+			*reinterpret_cast<std::size_t*>(block) = region.length;
+		}
+		return reinterpret_cast<T*>(block + HEADER_BYTES);
+	}
+
+	void deallocate(T* table, std::size_t)
+	{
+		char* block = reinterpret_cast<char*>(table) - HEADER_BYTES;
+		const std::size_t mapped_length = *reinterpret_cast<std::size_t*>(block);
+		if(mapped_length)
+		{
+			munmap(block, mapped_length);
+		} else {
+			::operator delete(block);
+		}
+	}
+private:
+	static constexpr std::size_t HEADER_BYTES = alignof(std::max_align_t);
+};
+
+template<typename T, typename U>
+bool operator==(const placement_allocator<T>&, const placement_allocator<U>&)
+{
+	return true;
+}
+
+template<typename T, typename U>
+bool operator!=(const placement_allocator<T>&, const placement_allocator<U>&)
+{
+	return false;
+}
+
+#endif
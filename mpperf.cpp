@@ -0,0 +1,33 @@
+//----------------------------------------------------------------------
+// FILE: mpperf.cpp
+// DESC: Driver program comparing single-pass multi-pattern search
+//       against one Boyer-Moore scan per pattern
+//----------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+#include "multi_search_tests.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	if(argc > 2)
+	{
+		std::cerr << "usage: " << argv[0] << " [filename]" << std::endl;
+		return 1;
+	}
+	// Use default file if no input file given
+	string file(argc==2 ? argv[1] : "test_in.txt");
+
+	if(!full_alphabet_check())
+	{
+		std::cerr << "multi-pattern engines disagree on the full byte alphabet" << std::endl;
+		return 1;
+	}
+
+	TD_TestDriver td = TD_TestDriver("    N x Boyer-Moore Search", boyermoore_each_set);
+	td.add_test("  Aho-Corasick (dense DFA)", aho_corasick_set);
+	td.add_test("      Wu-Manber (2-blocks)", wu_manber_set);
+	td.run_tests(file);
+}
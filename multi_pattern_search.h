@@ -0,0 +1,354 @@
+//----------------------------------------------------------------------
+// FILE: multi_pattern_search.h
+// DESC: Single-pass search for a set of patterns. Aho-Corasick compiled
+//       to a dense, byte-class compressed DFA, and Wu-Manber (the
+//       block-shift generalization of Commentz-Walter) for sets whose
+//       patterns are all long
+//----------------------------------------------------------------------
+
+#ifndef MULTI_PATTERN_SEARCH_H
+#define MULTI_PATTERN_SEARCH_H
+
+#include <string>
+#include <list>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "boyermoore.h"
+
+/**
+ * A single occurance of a pattern from a pattern set. pattern_id is the index of the
+ * pattern in the vector the engine was compiled from, and offset is the index in the
+ * text of the first character of the occurance
+ */
+struct pattern_match
+{
+	int pattern_id;
+	std::size_t offset;
+};
+
+/**
+ * Aho-Corasick automaton. Failure links are resolved while compiling, so the search loop
+ * is a single table lookup per text byte with no backtracking.
+ *
+ * Layout notes, since this is what makes the scan fast:
+ * - Bytes that never appear in any pattern all behave identically, so the alphabet is
+ *   compressed to byte classes. Class 0 is every byte absent from the pattern set, and
+ *   a row of the transition table is only class_count entries wide
+ * - Transition entries hold the row offset (state * class_count) of the next state
+ *   rather than the state number, removing a multiply from the scan
+ * - Entries leading into a state with outputs have the sign bit set, so the scan only
+ *   needs to test the value it just loaded to know whether to report
+ *
+ * Reference
+ * - https://en.wikipedia.org/wiki/Aho%E2%80%93Corasick_algorithm
+ */
+class aho_corasick
+{
+public:
+	explicit aho_corasick(const std::vector<std::string>& patterns);
+
+	/**
+	 * Appends every occurance of every pattern to matches, ordered by the position of the
+	 * last character of the occurance. Returns true if anything was found
+	 */
+	bool search(const std::string& text, std::list<pattern_match>& matches) const;
+
+	std::size_t state_count() const { return output_begin.size() - 1; }
+	int alphabet_classes() const { return class_count; }
+private:
+	static constexpr std::int32_t OUTPUT_FLAG = INT32_MIN;
+	static constexpr std::int32_t ROW_MASK = INT32_MAX;
+
+	int class_count;
+	// Classes 1...256 go to the bytes in the patterns, so a byte does not hold them all
+	std::uint16_t byte_class[256];
+	// states * class_count entries, see the class description for the encoding
+	std::vector<std::int32_t> transitions;
+	// Pattern ids reported in each state, including those inherited through failure
+	// links, stored as ranges [output_begin[s], output_begin[s+1]) of outputs
+	std::vector<std::int32_t> output_begin;
+	std::vector<std::int32_t> outputs;
+	std::vector<std::int32_t> pattern_lengths;
+};
+
+aho_corasick::aho_corasick(const std::vector<std::string>& patterns)
+: class_count(1)
+{
+	/*
+	Byte classes
+	*/
+	std::memset(byte_class, 0, sizeof(byte_class));
+	for(const auto& pattern : patterns)
+	{
+		for(unsigned char c : pattern)
+		{
+			// At most 256 distinct bytes, so classes end at 256 and class_count at 257
+			if(!byte_class[c]) byte_class[c] = static_cast<std::uint16_t>(class_count++);
+		}
+	}
+
+	/*
+	Trie. Missing edges are -1 until failure links are resolved below
+	*/
+	std::vector<std::int32_t> trie(class_count, -1);
+	std::vector<std::vector<std::int32_t>> state_outputs(1);
+	int state_total = 1;
+	for(std::size_t pattern_id = 0; pattern_id < patterns.size(); ++pattern_id)
+	{
+		const std::string& pattern = patterns[pattern_id];
+		pattern_lengths.push_back(pattern.length());
+		// Zero-width patterns trivially match everywhere and are not reported
+		if(pattern.empty()) continue;
+		int state = 0;
+		for(unsigned char c : pattern)
+		{
+			std::int32_t& edge = trie[state * class_count + byte_class[c]];
+			if(edge == -1)
+			{
+				edge = state_total++;
+				trie.resize(state_total * class_count, -1);
+				state_outputs.emplace_back();
+				// trie may have been reallocated by resize, so edge is not reused here
+				state = state_total - 1;
+				continue;
+			}
+			state = edge;
+		}
+		state_outputs[state].push_back(pattern_id);
+	}
+
+	/*
+	Failure links, resolved breadth first so that the failure state of every state has
+	already been completed by the time it is needed. After this, trie is the full DFA
+	*/
+	std::vector<std::int32_t> failure(state_total, 0);
+	std::vector<std::int32_t> queue;
+	queue.reserve(state_total);
+	for(int char_class = 0; char_class < class_count; ++char_class)
+	{
+		std::int32_t& edge = trie[char_class];
+		if(edge == -1) edge = 0;
+		else queue.push_back(edge);
+	}
+	for(std::size_t queue_index = 0; queue_index < queue.size(); ++queue_index)
+	{
+		const int state = queue[queue_index];
+		const int fallback = failure[state];
+		// Outputs of the longest proper suffix that is also a trie path are outputs here
+		state_outputs[state].insert(state_outputs[state].end(), state_outputs[fallback].begin(), state_outputs[fallback].end());
+		for(int char_class = 0; char_class < class_count; ++char_class)
+		{
+			std::int32_t& edge = trie[state * class_count + char_class];
+			if(edge == -1)
+			{
+				edge = trie[fallback * class_count + char_class];
+				continue;
+			}
+			failure[edge] = trie[fallback * class_count + char_class];
+			queue.push_back(edge);
+		}
+	}
+
+	/*
+	Flatten outputs and encode transitions
+	*/
+	output_begin.reserve(state_total + 1);
+	for(const auto& state_output : state_outputs)
+	{
+		output_begin.push_back(outputs.size());
+		outputs.insert(outputs.end(), state_output.begin(), state_output.end());
+	}
+	output_begin.push_back(outputs.size());
+	transitions.resize(trie.size());
+	for(std::size_t entry = 0; entry < trie.size(); ++entry)
+	{
+		const std::int32_t state = trie[entry];
+		transitions[entry] = state * class_count;
+		if(!state_outputs[state].empty()) transitions[entry] |= OUTPUT_FLAG;
+	}
+}
+
+bool aho_corasick::search(const std::string& text, std::list<pattern_match>& matches) const
+{
+	const unsigned char* text_bytes = reinterpret_cast<const unsigned char*>(text.c_str());
+	const std::size_t text_length = text.length();
+	const std::int32_t* table = &transitions[0];
+	bool found = false;
+	std::int32_t row = 0;
+	for(std::size_t text_index = 0; text_index < text_length; ++text_index)
+	{
+		const std::int32_t next = table[row + byte_class[text_bytes[text_index]]];
+		row = next & ROW_MASK;
+		if(next >= 0) continue;
+
+		/***  MATCH  ***/
+		const int state = row / class_count;
+		for(std::int32_t reported = output_begin[state]; reported < output_begin[state + 1]; ++reported)
+		{
+			const int pattern_id = outputs[reported];
+			matches.push_back({pattern_id, text_index + 1 - pattern_lengths[pattern_id]});
+		}
+		found = true;
+	}
+	return found;
+}
+
+/**
+ * Wu-Manber multi-pattern search. Like Commentz-Walter it skips through the text using
+ * a shift computed over the whole pattern set, but the shift is keyed on blocks of
+ * BLOCK_LENGTH characters instead of single characters, so it stays large even for big
+ * pattern sets. Only the first min_length characters of each pattern take part in the
+ * shift, so it works best when every pattern is long.
+ *
+ * Requires every pattern to be at least BLOCK_LENGTH characters long; use
+ * multi_pattern_search() to fall back to Aho-Corasick automatically.
+ *
+ * Reference
+ * - S. Wu and U. Manber, "A fast algorithm for multi-pattern searching", 1994
+ */
+class wu_manber
+{
+public:
+	static constexpr std::size_t BLOCK_LENGTH = 2;
+
+	explicit wu_manber(const std::vector<std::string>& patterns);
+
+	/**
+	 * Appends every occurance of every pattern to matches, ordered by the position of the
+	 * first character of the occurance. Returns true if anything was found
+	 */
+	bool search(const std::string& text, std::list<pattern_match>& matches) const;
+
+	std::size_t shortest_pattern() const { return min_length; }
+private:
+	static constexpr std::size_t TABLE_SIZE = 1 << (8 * BLOCK_LENGTH);
+
+	// With two-byte blocks the block value is its own perfect hash
+	static std::uint32_t block(const unsigned char* last)
+	{
+		return (std::uint32_t(last[-1]) << 8) | last[0];
+	}
+
+	std::vector<std::string> patterns;
+	std::size_t min_length;
+	// Distance the window can safely move when its last block hashes to a given value
+	std::vector<std::uint32_t> shift;
+	// Patterns whose min_length prefix ends in a given block, stored as ranges
+	// [bucket_begin[h], bucket_begin[h+1]) of bucket_patterns
+	std::vector<std::int32_t> bucket_begin;
+	std::vector<std::int32_t> bucket_patterns;
+	// Block value of the first two characters of each pattern, a cheap filter to run
+	// before the full comparison
+	std::vector<std::uint32_t> prefix_blocks;
+};
+
+wu_manber::wu_manber(const std::vector<std::string>& patterns)
+: patterns(patterns)
+, min_length(SIZE_MAX)
+, bucket_begin(TABLE_SIZE + 1, 0)
+{
+	for(const auto& pattern : patterns) min_length = std::min(min_length, pattern.length());
+	if(patterns.empty() || min_length < BLOCK_LENGTH)
+	{
+		// Unsupported set, leave an engine that never reports anything
+		min_length = SIZE_MAX;
+		return;
+	}
+
+	shift.assign(TABLE_SIZE, min_length - BLOCK_LENGTH + 1);
+	std::vector<std::uint32_t> last_blocks(patterns.size());
+	for(std::size_t pattern_id = 0; pattern_id < patterns.size(); ++pattern_id)
+	{
+		const unsigned char* pattern = reinterpret_cast<const unsigned char*>(patterns[pattern_id].c_str());
+		for(std::size_t block_end = BLOCK_LENGTH - 1; block_end < min_length; ++block_end)
+		{
+			std::uint32_t& block_shift = shift[block(pattern + block_end)];
+			block_shift = std::min<std::uint32_t>(block_shift, min_length - 1 - block_end);
+		}
+		last_blocks[pattern_id] = block(pattern + min_length - 1);
+		prefix_blocks.push_back(block(pattern + 1));
+		++bucket_begin[last_blocks[pattern_id] + 1];
+	}
+	// Counting sort of the pattern ids into their buckets
+	for(std::size_t hash = 0; hash < TABLE_SIZE; ++hash) bucket_begin[hash + 1] += bucket_begin[hash];
+	std::vector<std::int32_t> bucket_fill(bucket_begin.begin(), bucket_begin.end() - 1);
+	bucket_patterns.resize(patterns.size());
+	for(std::size_t pattern_id = 0; pattern_id < patterns.size(); ++pattern_id)
+	{
+		bucket_patterns[bucket_fill[last_blocks[pattern_id]]++] = pattern_id;
+	}
+}
+
+bool wu_manber::search(const std::string& text, std::list<pattern_match>& matches) const
+{
+	const unsigned char* text_bytes = reinterpret_cast<const unsigned char*>(text.c_str());
+	const std::size_t text_length = text.length();
+	bool found = false;
+	if(text_length < min_length) return false;
+
+	// window_end is the index of the last character of the min_length window
+	for(std::size_t window_end = min_length - 1; window_end < text_length;)
+	{
+		const std::uint32_t hash = block(text_bytes + window_end);
+		if(shift[hash])
+		{
+			window_end += shift[hash];
+			continue;
+		}
+
+		/***  CANDIDATE  ***/
+		const std::size_t window_start = window_end + 1 - min_length;
+		const std::uint32_t prefix = block(text_bytes + window_start + 1);
+		for(std::int32_t bucket = bucket_begin[hash]; bucket < bucket_begin[hash + 1]; ++bucket)
+		{
+			const int pattern_id = bucket_patterns[bucket];
+			if(prefix_blocks[pattern_id] != prefix) continue;
+			const std::string& pattern = patterns[pattern_id];
+			if(text_length - window_start < pattern.length()) continue;
+			if(std::memcmp(text_bytes + window_start, pattern.c_str(), pattern.length())) continue;
+			matches.push_back({pattern_id, window_start});
+			found = true;
+		}
+		++window_end;
+	}
+	return found;
+}
+
+// Shortest pattern length at which multi_pattern_search() prefers Wu-Manber. Below this
+// the maximum shift is too small to beat a table-driven automaton
+constexpr std::size_t WU_MANBER_MIN_PATTERN_LENGTH = 8;
+
+/**
+ * Compiles patterns and searches text in one call, using Wu-Manber when every pattern is
+ * at least WU_MANBER_MIN_PATTERN_LENGTH long and Aho-Corasick otherwise. Callers
+ * searching many texts with the same set should keep a compiled engine instead
+ */
+bool multi_pattern_search(const std::vector<std::string>& patterns, const std::string& text, std::list<pattern_match>& matches)
+{
+	std::size_t min_length = SIZE_MAX;
+	for(const auto& pattern : patterns) min_length = std::min(min_length, pattern.length());
+	if(patterns.empty()) return false;
+	if(min_length >= WU_MANBER_MIN_PATTERN_LENGTH) return wu_manber(patterns).search(text, matches);
+	return aho_corasick(patterns).search(text, matches);
+}
+
+/**
+ * Baseline for the engines above: one boyermoore() scan of text per pattern
+ */
+bool boyermoore_each(const std::vector<std::string>& patterns, const std::string& text, std::list<pattern_match>& matches)
+{
+	std::list<int> pattern_matches;
+	bool found = false;
+	for(std::size_t pattern_id = 0; pattern_id < patterns.size(); ++pattern_id)
+	{
+		pattern_matches.clear();
+		if(!boyermoore(patterns[pattern_id], text, pattern_matches)) continue;
+		for(int offset : pattern_matches) matches.push_back({int(pattern_id), std::size_t(offset)});
+		found = true;
+	}
+	return found;
+}
+
+#endif
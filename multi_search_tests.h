@@ -0,0 +1,184 @@
+#include <string>
+#include <list>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <unordered_set>
+#include "test_driver_decls.h"
+#include "search_corpus.h"
+#include "multi_pattern_search.h"
+
+// Harness configuration for multi-pattern engines. The pattern set is every distinct
+// pattern in the corpus file, and each record's text is searched for the whole set
+
+#define TD_ARGS *input->set, input->text, input->matches
+#define TD_RETURN_TO output->success
+#define TD_PRE_TIMER input->matches.clear();
+#define TD_POST_TIMER output->matched = input->matches.size();
+#define TD_INPUT MultiSearch
+#define TD_OUTPUT Results
+#define TD_DATA Metrics
+
+/**
+ * A pattern set along with the engines compiled from it. Compiling happens once per
+ * corpus, outside of the timed region, since that is how the engines are meant to be used
+ */
+struct multi_pattern_set
+{
+	explicit multi_pattern_set(const std::vector<std::string>& patterns)
+	: patterns(patterns)
+	, ac(patterns)
+	, wm(patterns)
+	{}
+
+	std::vector<std::string> patterns;
+	aho_corasick ac;
+	wu_manber wm;
+};
+struct MultiSearch : TD_TestInput
+{
+	const multi_pattern_set* set;
+	std::string text;
+	std::list<pattern_match> matches;
+};
+struct Results : TD_TestOutput
+{
+	bool success;
+	int matched;
+};
+
+TD_EXTEND
+struct Metrics : TD_TestMetricsBase
+{
+	TD_METRICS(Metrics)
+	{}
+
+	int match_count = 0;
+	int success_count = 0;
+
+	void print_result() const
+	{
+		using namespace std;
+		if(!this->success_count && this->match_count) return;
+
+		cout << "  Search" << " Found....: " << this->success_count << '\n';
+		cout << "  Search" << " Matches..: " << this->match_count
+			 << " occurances\n";
+		cout << " Average" << " Matches..: " << ((1.0 * this->match_count) / this->success_count)
+			 << " occurances\n";
+	}
+
+	void reset()
+	{
+		this->success_count = 0;
+		this->match_count = 0;
+	}
+};
+
+bool aho_corasick_set(const multi_pattern_set& set, const std::string& text, std::list<pattern_match>& matches)
+{
+	return set.ac.search(text, matches);
+}
+
+bool wu_manber_set(const multi_pattern_set& set, const std::string& text, std::list<pattern_match>& matches)
+{
+	return set.wm.search(text, matches);
+}
+
+bool boyermoore_each_set(const multi_pattern_set& set, const std::string& text, std::list<pattern_match>& matches)
+{
+	return boyermoore_each(set.patterns, text, matches);
+}
+
+/**
+ * Checks the compiled engines against one Boyer-Moore scan per pattern on binary pattern
+ * sets covering the whole byte alphabet, where the Aho-Corasick byte classes run up to 256:
+ * every single byte (too short for Wu-Manber, so Aho-Corasick only) and every byte followed
+ * by its complement. Returns false if an engine reports a different set of matches
+ */
+bool full_alphabet_check()
+{
+	const auto sorted = [](const std::list<pattern_match>& matches)
+	{
+		std::vector<std::pair<std::size_t, int>> found;
+		for(const pattern_match& match : matches) found.emplace_back(match.offset, match.pattern_id);
+		std::sort(found.begin(), found.end());
+		return found;
+	};
+
+	std::vector<std::string> single_bytes, byte_pairs;
+	std::string text;
+	for(int c = 0; c < 256; ++c)
+	{
+		single_bytes.push_back(std::string(1, static_cast<char>(c)));
+		byte_pairs.push_back(std::string(1, static_cast<char>(c)) + static_cast<char>(255 - c));
+		text += static_cast<char>(c);
+	}
+	single_bytes.push_back("\xff\xff");
+	single_bytes.push_back(std::string("\x00\xff", 2));
+	text += "\xff\xff";
+	text += text;
+
+	const multi_pattern_set single_set(single_bytes), pair_set(byte_pairs);
+	std::list<pattern_match> expected, found;
+	boyermoore_each_set(single_set, text, expected);
+	aho_corasick_set(single_set, text, found);
+	if(sorted(found) != sorted(expected)) return false;
+
+	expected.clear();
+	found.clear();
+	boyermoore_each_set(pair_set, text, expected);
+	aho_corasick_set(pair_set, text, found);
+	if(expected.empty() || sorted(found) != sorted(expected)) return false;
+	found.clear();
+	wu_manber_set(pair_set, text, found);
+	return sorted(found) == sorted(expected);
+}
+
+#define TD_USE_INPUT
+#define TD_USE_OUTPUT
+
+#include "TestDriver.h"
+
+// The whole corpus is read on the first call to collect the pattern set, then one text is
+// handed out per call. State is dropped at the end so the next run_tests() starts over
+TD_PREPARE_INPUT
+{
+	static std::vector<std::string> texts;
+	static multi_pattern_set* set = nullptr;
+	static std::size_t next_text = 0;
+
+	if(!set)
+	{
+		std::vector<std::string> patterns;
+		std::unordered_set<std::string> seen;
+		std::string pattern, text;
+		while(read_corpus_record(TD_infile, pattern, text))
+		{
+			if(seen.insert(pattern).second) patterns.push_back(pattern);
+			texts.push_back(text);
+		}
+		set = new multi_pattern_set(patterns);
+		// The stream hit end of file above, but the driver keeps calling while it is good
+		TD_infile.clear();
+	}
+	if(next_text == texts.size())
+	{
+		delete set;
+		set = nullptr;
+		texts.clear();
+		next_text = 0;
+		return false;
+	}
+
+	input->set = set;
+	input->text = texts[next_text++];
+	return true;
+}
+
+TD_HANDLE_OUTPUT
+{
+	data->match_count += output->matched;
+	data->success_count += output->success;
+}
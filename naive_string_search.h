@@ -5,26 +5,66 @@
 
 #include <string>
 #include <list>
+#include <cstring>
+#include "match_sinks.h"
 
-bool naive_string_search(const std::string& pattern, const std::string& text, std::list<int>& matches)
+/**
+ * How common a byte is in typical text, higher being more common: English letters by
+ * frequency, then the space, digits and punctuation above everything else. Only the order
+ * matters, as a guess for which byte of a pattern the text will contain the fewest of
+ */
+int byte_frequency_rank(unsigned char c)
 {
-	const int n = text.length();
-    const int m = pattern.length();
+	static const char* const LETTERS_BY_FREQUENCY = "zqxjkvbpygfwmucldrhsnioate";
+	if(c == ' ') return 64;
+	if(c >= 'a' && c <= 'z') return 32 + std::strchr(LETTERS_BY_FREQUENCY, c) - LETTERS_BY_FREQUENCY;
+	if(c >= 'A' && c <= 'Z') return 4 + std::strchr(LETTERS_BY_FREQUENCY, c - 'A' + 'a') - LETTERS_BY_FREQUENCY;
+	if(c >= '0' && c <= '9') return 3;
+	if(c >= 0x20 && c < 0x7f) return 2;
+	if(c == '\n' || c == '\t') return 2;
+	return 1;
+}
+
+/**
+ * Checks every alignment of the pattern against the text, with no preprocessing beyond
+ * picking the pattern byte least likely to occur in the text. memchr skips to the next
+ * occurance of that byte, and memcmp checks the whole pattern wherever it lines up, so
+ * the per-byte work is done by the C library's vectorized routines
+ */
+template<typename Sink>
+bool naive_search(const std::string& pattern, const std::string& text, Sink&& sink)
+{
+	const std::size_t n = text.length();
+	const std::size_t m = pattern.length();
 	if(n < m) return false;
 	if(m == 0) return true;
 
-    int i, j;
+	std::size_t rare = 0;
+	for(std::size_t i = 1; i < m; ++i)
+	{
+		if(byte_frequency_rank(pattern[i]) < byte_frequency_rank(pattern[rare])) rare = i;
+	}
+
+	const char* const text_chars = text.c_str();
+	const char* const pattern_chars = pattern.c_str();
+	// The rare byte of every alignment lies in text[rare...n-m+rare]
+	const char* const end = text_chars + n - m + rare + 1;
+	bool found = false;
 
-    for(i = 0; i < n-m+1; ++i)
-    {
-        for(j = 0; j < m; ++j)
-        {
-            if(text[i+j] != pattern[j]) break;
-        }
-        if(j == m) matches.push_back(i);
-    }
+	for(const char* hit = text_chars + rare; (hit = (const char*)std::memchr(hit, pattern[rare], end - hit)); ++hit)
+	{
+		const char* const alignment = hit - rare;
+		if(std::memcmp(alignment, pattern_chars, m)) continue;
+		found = true;
+		if(!report_match(sink, alignment - text_chars)) break;
+	}
 
-    return !!matches.size();
+	return found;
+}
+
+bool naive_string_search(const std::string& pattern, const std::string& text, std::list<int>& matches)
+{
+	return naive_search(pattern, text, list_sink{matches});
 }
 
 #endif
@@ -0,0 +1,190 @@
+//----------------------------------------------------------------------
+// FILE: parallel_search.h
+// DESC: Multi-threaded Boyer-Moore search of one large text, split
+//       into overlapping segments searched on a thread pool
+//----------------------------------------------------------------------
+
+#ifndef PARALLEL_SEARCH_H
+#define PARALLEL_SEARCH_H
+
+#include <string>
+#include <list>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <cstring>
+#include "boyermoore.h"
+
+/**
+ * Fixed set of worker threads for running batches of independent tasks. The thread that
+ * calls run() works on the batch too, so a pool of size N starts N-1 threads
+ */
+class search_thread_pool
+{
+public:
+	explicit search_thread_pool(unsigned threads = std::thread::hardware_concurrency())
+	{
+		for(unsigned worker = 1; worker < threads; ++worker) this->workers.emplace_back(&search_thread_pool::work, this);
+	}
+
+	~search_thread_pool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(this->lock);
+			this->stopping = true;
+		}
+		this->wake.notify_all();
+		for(auto& worker : this->workers) worker.join();
+	}
+
+	search_thread_pool(const search_thread_pool&) = delete;
+	search_thread_pool& operator=(const search_thread_pool&) = delete;
+
+	unsigned size() const { return this->workers.size() + 1; }
+
+	/**
+	 * Calls task(index) for every index in [0, tasks), spread over the pool, and returns
+	 * once every call has finished
+	 */
+	void run(std::size_t tasks, const std::function<void(std::size_t)>& task)
+	{
+		if(!tasks) return;
+		auto current = std::make_shared<batch>(task, tasks);
+		{
+			std::lock_guard<std::mutex> guard(this->lock);
+			this->current = current;
+			++this->generation;
+		}
+		this->wake.notify_all();
+		current->work();
+		std::unique_lock<std::mutex> guard(current->lock);
+		current->finished.wait(guard, [&current] { return !current->pending; });
+	}
+private:
+	// One call to run(). Workers hold on to the batch they picked up, so one that wakes up
+	// late can never take a task from the batch after it
+	struct batch
+	{
+		batch(const std::function<void(std::size_t)>& task, std::size_t tasks)
+		: task(task)
+		, tasks(tasks)
+		, pending(tasks)
+		{}
+
+		void work()
+		{
+			for(std::size_t index; (index = this->next++) < this->tasks;)
+			{
+				this->task(index);
+				if(--this->pending) continue;
+				std::lock_guard<std::mutex> guard(this->lock);
+				this->finished.notify_all();
+			}
+		}
+
+		const std::function<void(std::size_t)>& task;
+		const std::size_t tasks;
+		std::atomic<std::size_t> next{0};
+		std::atomic<std::size_t> pending;
+		std::mutex lock;
+		std::condition_variable finished;
+	};
+
+	void work()
+	{
+		unsigned long seen = 0;
+		for(;;)
+		{
+			std::shared_ptr<batch> picked;
+			{
+				std::unique_lock<std::mutex> guard(this->lock);
+				this->wake.wait(guard, [this, seen] { return this->stopping || this->generation != seen; });
+				if(this->stopping) return;
+				seen = this->generation;
+				picked = this->current;
+			}
+			picked->work();
+		}
+	}
+
+	std::vector<std::thread> workers;
+	std::mutex lock;
+	std::condition_variable wake;
+	std::shared_ptr<batch> current;
+	unsigned long generation = 0;
+	bool stopping = false;
+};
+
+// Segments smaller than this are not worth handing to another thread
+constexpr std::size_t PARALLEL_MIN_SEGMENT = 64 << 10;
+
+/**
+ * Searches text for pattern on every thread of pool, returning the offsets of all matches
+ * in increasing order.
+ *
+ * The text is split into one segment per thread. Each segment owns the alignments that
+ * start inside it, and is searched together with the first pattern_length-1 bytes of the
+ * next segment so those alignments can be checked in full. Since every match start is
+ * owned by exactly one segment, concatenating the per-segment results in segment order
+ * gives the matches in order without duplicates
+ */
+std::vector<std::size_t> parallel_boyermoore_search(const std::string& pattern, const char* text, std::size_t text_length, search_thread_pool& pool)
+{
+	const std::size_t pattern_length = pattern.length();
+	if(!pattern_length || text_length < pattern_length) return {};
+
+	const std::size_t starts = text_length - pattern_length + 1;
+	std::size_t segments = (starts + PARALLEL_MIN_SEGMENT - 1) / PARALLEL_MIN_SEGMENT;
+	if(segments > pool.size()) segments = pool.size();
+	const std::size_t segment_length = (starts + segments - 1) / segments;
+
+	std::unique_ptr<boyermoore_pattern> compiled;
+	if(pattern_length >= 2) compiled.reset(new boyermoore_pattern(pattern));
+	std::vector<std::vector<std::size_t>> found(segments);
+	pool.run(segments, [&](std::size_t segment)
+	{
+		const std::size_t segment_start = segment * segment_length;
+		if(segment_start >= starts) return;
+		const std::size_t segment_end = segment_start + segment_length < starts ? segment_start + segment_length : starts;
+		// Every alignment starting in the segment, through to its last character
+		const char* searched = text + segment_start;
+		const std::size_t searched_length = segment_end - segment_start + pattern_length - 1;
+		std::vector<std::size_t>& matches = found[segment];
+		if(pattern_length == 1)
+		{
+			for(const char* hit = searched; (hit = (const char*)std::memchr(hit, pattern[0], searched + searched_length - hit)); ++hit)
+			{
+				matches.push_back(segment_start + (hit - searched));
+			}
+			return;
+		}
+		apostolico_giancarlo_ring apostolico_giancarlo_skip(pattern_length);
+		boyermoore_scan(*compiled, apostolico_giancarlo_skip, searched, searched_length, pattern_length - 1,
+			[&](std::ptrdiff_t match) { matches.push_back(segment_start + match); });
+	});
+
+	std::size_t total = 0;
+	for(const auto& segment : found) total += segment.size();
+	std::vector<std::size_t> matches;
+	matches.reserve(total);
+	for(const auto& segment : found) matches.insert(matches.end(), segment.begin(), segment.end());
+	return matches;
+}
+
+/**
+ * parallel_boyermoore_search() with the boyermoore() signature, on a pool of THREADS
+ * threads that is started on first use
+ */
+template<unsigned THREADS>
+bool parallel_boyermoore(const std::string& pattern, const std::string& text, std::list<int>& matches)
+{
+	static search_thread_pool pool(THREADS);
+	for(std::size_t match : parallel_boyermoore_search(pattern, text.c_str(), text.length(), pool)) matches.push_back(match);
+	return !!matches.size();
+}
+
+#endif
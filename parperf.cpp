@@ -0,0 +1,33 @@
+//----------------------------------------------------------------------
+// FILE: parperf.cpp
+// DESC: Driver program for thread scaling of partitioned Boyer-Moore
+//       search. Use corpusgen for texts large enough to split
+//----------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+#include "boyermoore.h"
+#include "parallel_search.h"
+#include "search_tests_example.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	if(argc > 2)
+	{
+		std::cerr << "usage: " << argv[0] << " [filename]" << std::endl;
+		return 1;
+	}
+	// Use default file if no input file given
+	string file(argc==2 ? argv[1] : "test_in.txt");
+
+	TD_TestDriver td = TD_TestDriver("   Boyer-Moore String Search", boyermoore);
+	td.add_test(" Partitioned BM ( 1 thread )", parallel_boyermoore<1>);
+	td.add_test(" Partitioned BM ( 2 threads)", parallel_boyermoore<2>);
+	td.add_test(" Partitioned BM ( 4 threads)", parallel_boyermoore<4>);
+	td.add_test(" Partitioned BM ( 8 threads)", parallel_boyermoore<8>);
+	td.add_test(" Partitioned BM (16 threads)", parallel_boyermoore<16>);
+	td.add_test(" Partitioned BM (32 threads)", parallel_boyermoore<32>);
+	td.run_tests(file);
+}
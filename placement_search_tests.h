@@ -0,0 +1,142 @@
+#include <string>
+#include <iostream>
+#include <cstring>
+#include "test_driver_decls.h"
+#include "search_corpus.h"
+#include "match_sinks.h"
+#include "memory_placement.h"
+#include "boyermoore.h"
+
+// Harness configuration for memory placement. Each text is copied into memory placed by
+// corpus_placement, and the functions search it where it lies, so they take the text as
+// a pointer and length rather than as a std::string
+
+#define TD_ARGS input->pattern, input->text
+#define TD_RETURN_TO output->matched
+#define TD_INPUT PlacedSearch
+#define TD_OUTPUT Results
+#define TD_DATA Metrics
+
+// Placement of the corpus texts, and what they were given. The driver program sets the
+// placement before run_tests()
+memory_placement corpus_placement;
+placement_tally corpus_tally;
+
+struct placed_text
+{
+	const char* chars = nullptr;
+	std::size_t length = 0;
+};
+struct PlacedSearch : TD_TestInput
+{
+	PlacedSearch() = default;
+	PlacedSearch(const PlacedSearch&) = delete;
+	PlacedSearch& operator=(const PlacedSearch&) = delete;
+	~PlacedSearch()
+	{
+		release_memory(this->region);
+	}
+
+	std::string pattern;
+	placed_text text;
+	placed_region region;
+};
+struct Results : TD_TestOutput
+{
+	std::size_t matched;
+};
+
+TD_EXTEND
+struct Metrics : TD_TestMetricsBase
+{
+	TD_METRICS(Metrics)
+	{}
+
+	std::size_t match_count = 0;
+	int success_count = 0;
+
+	void print_result() const
+	{
+		using namespace std;
+		if(!this->success_count && this->match_count) return;
+
+		cout << "  Search" << " Found....: " << this->success_count << '\n';
+		cout << "  Search" << " Matches..: " << this->match_count
+			 << " occurances\n";
+	}
+
+	void reset()
+	{
+		this->success_count = 0;
+		this->match_count = 0;
+	}
+};
+
+std::size_t boyermoore_placed(const std::string& pattern, const placed_text& text)
+{
+	count_sink matches;
+	if(pattern.empty() || text.length < pattern.length()) return 0;
+	if(pattern.length() == 1)
+	{
+		const char* const end = text.chars + text.length;
+		for(const char* hit = text.chars; (hit = (const char*)std::memchr(hit, pattern[0], end - hit)); ++hit) ++matches.count;
+		return matches.count;
+	}
+	// Tables large enough for PLACEMENT_MIN_BYTES are placed by engine_table_placement
+	const boyermoore_pattern compiled(pattern);
+	apostolico_giancarlo_ring apostolico_giancarlo_skip(pattern.length());
+	boyermoore_scan(compiled, apostolico_giancarlo_skip, text.chars, text.length, pattern.length() - 1, matches);
+	return matches.count;
+}
+
+std::size_t memmem_placed(const std::string& pattern, const placed_text& text)
+{
+	std::size_t matched = 0;
+	if(pattern.empty()) return 0;
+	const char* const end = text.chars + text.length;
+	for(const char* hit = text.chars; hit < end; ++hit)
+	{
+		hit = (const char*)memmem(hit, end - hit, pattern.c_str(), pattern.length());
+		if(!hit) break;
+		++matched;
+	}
+	return matched;
+}
+
+/**
+ * Prints the placement asked for and what the texts and engine tables of the last run
+ * were actually given
+ */
+void print_placement()
+{
+	using namespace std;
+	cout << "  Requested.......: " << describe_placement(corpus_placement) << '\n';
+	cout << "  Corpus" << " Texts....: " << corpus_tally.describe() << '\n';
+	cout << "  Engine" << " Tables...: " << engine_table_tally.describe() << '\n';
+	cout << endl;
+}
+
+#define TD_USE_INPUT
+#define TD_USE_OUTPUT
+
+#include "TestDriver.h"
+
+TD_PREPARE_INPUT
+{
+	// Read into a buffer reused between records, then copied to the placed memory
+	static std::string text;
+	if(!read_corpus_record(TD_infile, input->pattern, text)) return false;
+	input->region = place_memory(text.length(), corpus_placement);
+	if(!input->region.address) return false;
+	std::memcpy(input->region.address, text.c_str(), text.length());
+	input->text.chars = static_cast<const char*>(input->region.address);
+	input->text.length = text.length();
+	corpus_tally.add(input->region.granted);
+	return true;
+}
+
+TD_HANDLE_OUTPUT
+{
+	data->match_count += output->matched;
+	data->success_count += !!output->matched;
+}
@@ -0,0 +1,44 @@
+//----------------------------------------------------------------------
+// FILE: placeperf.cpp
+// DESC: Driver program for search over texts and engine tables placed
+//       on huge pages and bound to a NUMA node
+//----------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+#include <cstdlib>
+#include "placement_search_tests.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	if(argc > 3)
+	{
+		std::cerr << "usage: " << argv[0] << " [filename] [numa_node]" << std::endl;
+		return 1;
+	}
+	// Use default file if no input file given
+	string file(argc>=2 ? argv[1] : "test_in.txt");
+	// Without a node, memory goes wherever the kernel puts it (usually the node touching it first)
+	const int numa_node = argc==3 ? atoi(argv[2]) : -1;
+
+	TD_TestDriver td = TD_TestDriver(" Boyer-Moore String Search", boyermoore_placed);
+	td.add_test("      memmem String Search", memmem_placed);
+
+	// The same corpus and engines under each page size, the texts and tables placed alike
+	for(page_size_policy pages : {page_size_policy::standard, page_size_policy::transparent_huge, page_size_policy::explicit_huge})
+	{
+		corpus_placement.pages = pages;
+		corpus_placement.numa_node = numa_node;
+		engine_table_placement = corpus_placement;
+		corpus_tally.reset();
+		engine_table_tally.reset();
+
+		const string title = " Placement: " + describe_placement(corpus_placement);
+		cout << '\n' << title << '\n' << string(title.length(), '=') << '\n';
+		td.run_tests(file);
+		cout << "\n Placement Granted\n==================\n\n";
+		print_placement();
+	}
+}
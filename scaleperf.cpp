@@ -0,0 +1,42 @@
+//----------------------------------------------------------------------
+// FILE: scaleperf.cpp
+// DESC: Driver program for concurrent load: each search engine run
+//       from 1..N threads at once, one search per thread at a time
+//----------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+#include <cstdlib>
+#include "boyermoore.h"
+#include "naive_string_search.h"
+#include "horspool.h"
+#include "two_way.h"
+// Concurrent runs are a separate report from the usual per-function results
+#define TD_USE_SCALING
+#include "search_tests_example.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	if(argc > 3)
+	{
+		std::cerr << "usage: " << argv[0] << " [filename] [max_threads]" << std::endl;
+		return 1;
+	}
+	// Use default file if no input file given
+	string file(argc>=2 ? argv[1] : "test_in.txt");
+	// Matches the number of request threads in production by default
+	const int max_threads = argc==3 ? atoi(argv[2]) : 32;
+	if(max_threads < 1)
+	{
+		std::cerr << argv[0] << ": max_threads must be at least 1" << std::endl;
+		return 1;
+	}
+
+	TD_TestDriver td = TD_TestDriver(" Boyer-Moore String Search", boyermoore);
+	td.add_test("       Naive String Search", naive_string_search);
+	td.add_test("    Horspool String Search", horspool);
+	td.add_test("     Two-Way String Search", two_way);
+	td.run_scaling_tests(file, max_threads);
+}
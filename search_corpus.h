@@ -0,0 +1,74 @@
+//----------------------------------------------------------------------
+// FILE: search_corpus.h
+// DESC: Reader for the length-prefixed search corpus format used by
+//       test_in.txt. Each record is a pattern field followed by a text
+//       field, and each field is written as "<length>\0<bytes>\0". The
+//       terminator of the final field in a file is optional
+//----------------------------------------------------------------------
+
+#ifndef SEARCH_CORPUS_H
+#define SEARCH_CORPUS_H
+
+#include <string>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+#include <cstdlib>
+
+/**
+ * Reads a single field from a corpus stream into field. Returns false at end of input,
+ * on a zero or malformed length, or on a short read; field is unspecified in that case
+ */
+bool read_corpus_field(std::istream& in, std::string& field)
+{
+	char in_len[12] = {};
+
+	in.getline(in_len, sizeof(in_len), '\0');
+	if(!in) return false;
+	const long len = atol(in_len);
+	if(len <= 0) return false;
+	field.resize(len);
+	in.read(&field[0], len);
+	if(in.gcount() != len) return false;
+	// Consume the terminator, which may be missing on the final field of the file
+	if(in.peek() == '\0') in.ignore();
+	return true;
+}
+
+/**
+ * Steps over a single field without reading its bytes, recording where in the stream they
+ * are so they can be read later, e.g. in pieces. Same return value as read_corpus_field
+ */
+bool skip_corpus_field(std::istream& in, std::uint64_t& offset, std::uint64_t& length)
+{
+	char in_len[12] = {};
+
+	in.getline(in_len, sizeof(in_len), '\0');
+	if(!in) return false;
+	const long len = atol(in_len);
+	if(len <= 0) return false;
+	offset = in.tellg();
+	length = len;
+	in.seekg(len, std::ios::cur);
+	if(!in) return false;
+	if(in.peek() == '\0') in.ignore();
+	return true;
+}
+
+void write_corpus_field(std::ostream& out, const std::string& field)
+{
+	out << field.length();
+	out.put('\0');
+	out.write(field.c_str(), field.length());
+	out.put('\0');
+}
+
+/**
+ * Reads one complete (pattern, text) record. Returns false if either field is missing
+ */
+bool read_corpus_record(std::istream& in, std::string& pattern, std::string& text)
+{
+	return read_corpus_field(in, pattern) && read_corpus_field(in, text);
+}
+
+#endif
@@ -0,0 +1,235 @@
+//----------------------------------------------------------------------
+// FILE: search_dispatch.h
+// DESC: Front end that picks a search engine for each pattern and text
+//       from thresholds calibrated on the host (see calibrate.cpp)
+//----------------------------------------------------------------------
+
+#ifndef SEARCH_DISPATCH_H
+#define SEARCH_DISPATCH_H
+
+#include <string>
+#include <list>
+#include <fstream>
+#include <optional>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include "match_sinks.h"
+#include "naive_string_search.h"
+#include "horspool.h"
+#include "boyermoore.h"
+#include "two_way.h"
+
+enum class search_engine
+{
+	memchr,
+	naive,
+	horspool,
+	boyermoore,
+	two_way
+};
+
+const char* search_engine_name(search_engine engine)
+{
+	switch(engine)
+	{
+	case search_engine::memchr: return "memchr";
+	case search_engine::naive: return "naive";
+	case search_engine::horspool: return "horspool";
+	case search_engine::boyermoore: return "boyermoore";
+	case search_engine::two_way: return "two_way";
+	}
+	return "";
+}
+
+/**
+ * Looks up an engine by search_engine_name(). Returns false if there is no such engine
+ */
+bool parse_search_engine(const std::string& name, search_engine& engine)
+{
+	for(search_engine candidate : {search_engine::memchr, search_engine::naive, search_engine::horspool,
+		search_engine::boyermoore, search_engine::two_way})
+	{
+		if(name != search_engine_name(candidate)) continue;
+		engine = candidate;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Thresholds used by choose_search_engine(). The defaults are only a starting point; the
+ * crossovers move a long way between machines and compilers, so calibrate writes measured
+ * values to a profile file that host_search_profile() loads
+ */
+struct search_profile
+{
+	// Texts up to this long are searched naively, since preprocessing a pattern costs
+	// more than it can save
+	std::size_t naive_max_text = 256;
+	// Patterns up to this long are searched naively
+	std::size_t naive_max_pattern = 3;
+	// Patterns with at most this many distinct characters get Boyer-Moore, whose good
+	// suffix rule keeps shifting when the bad character shifts are short
+	std::size_t boyermoore_max_distinct = 4;
+	// Up to this long, the remaining patterns get Horspool; longer ones Boyer-Moore
+	std::size_t horspool_max_pattern = 64;
+	// Engine for patterns that repeat, i.e. have a period of at most half their length
+	search_engine periodic_engine = search_engine::two_way;
+};
+
+/**
+ * Reads a profile written by save_search_profile(). Each line is a field name and value;
+ * fields that are missing keep their current value in profile. Returns false if the file
+ * cannot be read or has a line that is not understood
+ */
+bool load_search_profile(const std::string& filename, search_profile& profile)
+{
+	std::ifstream in(filename);
+	if(!in) return false;
+	std::string name, value;
+	while(in >> name >> value)
+	{
+		if(name == "periodic_engine")
+		{
+			if(!parse_search_engine(value, profile.periodic_engine)) return false;
+			continue;
+		}
+		std::size_t* field = name == "naive_max_text" ? &profile.naive_max_text
+			: name == "naive_max_pattern" ? &profile.naive_max_pattern
+			: name == "boyermoore_max_distinct" ? &profile.boyermoore_max_distinct
+			: name == "horspool_max_pattern" ? &profile.horspool_max_pattern
+			: nullptr;
+		if(!field) return false;
+		*field = std::strtoull(value.c_str(), nullptr, 10);
+	}
+	return in.eof();
+}
+
+bool save_search_profile(const std::string& filename, const search_profile& profile)
+{
+	std::ofstream out(filename);
+	out << "naive_max_text " << profile.naive_max_text << '\n';
+	out << "naive_max_pattern " << profile.naive_max_pattern << '\n';
+	out << "boyermoore_max_distinct " << profile.boyermoore_max_distinct << '\n';
+	out << "horspool_max_pattern " << profile.horspool_max_pattern << '\n';
+	out << "periodic_engine " << search_engine_name(profile.periodic_engine) << '\n';
+	return !!out;
+}
+
+// Profile file read by host_search_profile() when SEARCH_PROFILE is not set
+const char* const DEFAULT_SEARCH_PROFILE = "search_profile.txt";
+
+/**
+ * The profile for this machine, loaded on first use from the file named by the
+ * SEARCH_PROFILE environment variable, or DEFAULT_SEARCH_PROFILE. Without a readable
+ * profile the defaults in search_profile are used
+ */
+const search_profile& host_search_profile()
+{
+	static const search_profile profile = []
+	{
+		search_profile loaded;
+		const char* filename = std::getenv("SEARCH_PROFILE");
+		if(!load_search_profile(filename ? filename : DEFAULT_SEARCH_PROFILE, loaded)) loaded = search_profile();
+		return loaded;
+	}();
+	return profile;
+}
+
+/**
+ * Picks the engine for searching a text of text_length characters for pattern. Looks at
+ * the pattern length, its number of distinct characters and whether it is periodic, all
+ * in O(pattern_length). Periodicity comes from Two-Way's factorization, which is only
+ * computed when the cheaper tests leave it open; it is left in factored, so that
+ * search_with() does not have to factorize the pattern again
+ */
+search_engine choose_search_engine(const std::string& pattern, std::size_t text_length, const search_profile& profile,
+	std::optional<two_way_pattern>& factored)
+{
+	const std::size_t pattern_length = pattern.length();
+	if(pattern_length == 1) return search_engine::memchr;
+	if(pattern_length < 2 || text_length <= profile.naive_max_text) return search_engine::naive;
+	if(pattern_length <= profile.naive_max_pattern) return search_engine::naive;
+
+	bool seen[UCHAR_MAX + 1] = {};
+	std::size_t distinct = 0;
+	for(unsigned char c : pattern)
+	{
+		if(seen[c]) continue;
+		seen[c] = true;
+		++distinct;
+	}
+
+	// A pattern with period p has at most p distinct characters, so one with more than half
+	// its length in distinct characters cannot repeat
+	if(2 * distinct <= pattern_length)
+	{
+		factored.emplace(pattern);
+		if(factored->periodic() && 2 * std::size_t(factored->period()) <= pattern_length) return profile.periodic_engine;
+	}
+	if(distinct <= profile.boyermoore_max_distinct) return search_engine::boyermoore;
+	return pattern_length <= profile.horspool_max_pattern ? search_engine::horspool : search_engine::boyermoore;
+}
+
+search_engine choose_search_engine(const std::string& pattern, std::size_t text_length, const search_profile& profile)
+{
+	std::optional<two_way_pattern> factored;
+	return choose_search_engine(pattern, text_length, profile, factored);
+}
+
+/**
+ * Searches text for pattern with the given engine, reporting matches to sink. memchr only
+ * handles single character patterns, and falls back to naive search for any other. Two-Way
+ * uses factored, the pattern's factorization, if it is given
+ */
+template<typename Sink>
+bool search_with(search_engine engine, const std::string& pattern, const std::string& text, Sink&& sink,
+	const two_way_pattern* factored = nullptr)
+{
+	switch(engine)
+	{
+	case search_engine::memchr:
+		if(pattern.length() == 1 && text.length())
+		{
+			bool found = false;
+			const char* const end = text.c_str() + text.length();
+			for(const char* hit = text.c_str(); (hit = (const char*)std::memchr(hit, pattern[0], end - hit)); ++hit)
+			{
+				found = true;
+				if(!report_match(sink, hit - text.c_str())) break;
+			}
+			return found;
+		}
+		return naive_search(pattern, text, sink);
+	case search_engine::naive:
+		return naive_search(pattern, text, sink);
+	case search_engine::horspool:
+		return horspool_search(pattern, text, sink);
+	case search_engine::boyermoore:
+		return boyermoore_search(pattern, text, sink);
+	case search_engine::two_way:
+		if(factored) return factored->search(text.c_str(), text.length(), sink);
+		return two_way_pattern(pattern).search(text.c_str(), text.length(), sink);
+	}
+	return false;
+}
+
+/**
+ * Searches text for pattern with whichever engine the host profile picks for them
+ */
+template<typename Sink>
+bool adaptive_search(const std::string& pattern, const std::string& text, Sink&& sink)
+{
+	std::optional<two_way_pattern> factored;
+	const search_engine engine = choose_search_engine(pattern, text.length(), host_search_profile(), factored);
+	return search_with(engine, pattern, text, sink, factored ? &*factored : nullptr);
+}
+
+bool adaptive_string_search(const std::string& pattern, const std::string& text, std::list<int>& matches)
+{
+	return adaptive_search(pattern, text, list_sink{matches});
+}
+
+#endif
@@ -1,12 +1,16 @@
 #include <string>
 #include <list>
+#include <map>
+#include <vector>
+#include <chrono>
+#include <algorithm>
 #include <iostream>
 #include "test_driver_decls.h"
 
 #define TD_ARGS input->pattern, input->text, input->matches
 #define TD_RETURN_TO output->success
 #define TD_PRE_TIMER input->matches.clear();
-#define TD_POST_TIMER output->matched = input->matches.size();
+#define TD_POST_TIMER output->matched = input->matches.size(); output->elapsed = time;
 #define TD_INPUT Search
 #define TD_OUTPUT Results
 #define TD_DATA Metrics
@@ -20,14 +24,20 @@ struct Results : TD_TestOutput
 {
 	bool success;
 	int matched;
+	std::chrono::microseconds elapsed;
 };
 
+// Total time taken by each function under test, by header, for print_ranking()
+std::map<std::string, std::chrono::microseconds> search_ranking;
+
 TD_EXTEND
 struct Metrics : TD_TestMetricsBase
 {
 	TD_METRICS(Metrics)
+	, name(h)
 	{}
 
+	std::string name;
 	int match_count = 0;
 	int success_count = 0;
 
@@ -50,6 +60,20 @@ struct Metrics : TD_TestMetricsBase
 	}
 };
 
+/**
+ * Input class for the paired comparison: the pattern length, in power of two buckets
+ */
+std::string pattern_length_class(std::size_t length)
+{
+	if(length < 2) return "m=" + std::to_string(length);
+	std::size_t low = 1;
+	while(low * 2 <= length) low *= 2;
+	return "m=" + std::to_string(low) + '-' + std::to_string(low * 2 - 1);
+}
+
+#define TD_INPUT_CLASS pattern_length_class(input->pattern.length())
+#define TD_INPUT_DESCRIPTION "m=" + std::to_string(input->pattern.length()) + ", n=" + std::to_string(input->text.length())
+
 #define TD_USE_INPUT
 #define TD_USE_OUTPUT
 
@@ -100,4 +124,30 @@ TD_HANDLE_OUTPUT
 {
 	data->match_count += output->matched;
 	data->success_count += output->success;
+	search_ranking[data->name] += output->elapsed;
+}
+
+/**
+ * Prints every function run so far from fastest to slowest by total time
+ */
+void print_ranking()
+{
+	using namespace std;
+	// Empty when the functions ran in processes of their own (TD_USE_ISOLATION)
+	if(search_ranking.empty()) return;
+	vector<pair<chrono::microseconds, string>> ranked;
+	for(const auto& function : search_ranking)
+	{
+		const string& header = function.first;
+		ranked.emplace_back(function.second, header.substr(header.find_first_not_of(' ')));
+	}
+	sort(ranked.begin(), ranked.end());
+
+	cout << "\n Ranking by Total Time\n======================\n\n";
+	for(size_t place = 0; place < ranked.size(); ++place)
+	{
+		cout << "  " << place + 1 << ". " << ranked[place].second << ": " << ranked[place].first.count()
+			 << " microseconds\n";
+	}
+	cout << endl;
 }
@@ -0,0 +1,120 @@
+#include <string>
+#include <list>
+#include <vector>
+#include <iostream>
+#include "test_driver_decls.h"
+#include "search_corpus.h"
+#include "match_sinks.h"
+#include "boyermoore.h"
+#include "naive_string_search.h"
+
+// Harness configuration for comparing match sinks. Every function returns how many
+// matches its sink saw, so the std::list<int> path and the sinks share one signature
+
+#define TD_ARGS input->pattern, input->text
+#define TD_RETURN_TO output->matched
+#define TD_INPUT Search
+#define TD_OUTPUT Results
+#define TD_DATA Metrics
+struct Search : TD_TestInput
+{
+	std::string pattern;
+	std::string text;
+};
+struct Results : TD_TestOutput
+{
+	std::size_t matched;
+};
+
+TD_EXTEND
+struct Metrics : TD_TestMetricsBase
+{
+	TD_METRICS(Metrics)
+	{}
+
+	std::size_t match_count = 0;
+	int success_count = 0;
+
+	void print_result() const
+	{
+		using namespace std;
+		if(!this->success_count && this->match_count) return;
+
+		cout << "  Search" << " Found....: " << this->success_count << '\n';
+		cout << "  Search" << " Matches..: " << this->match_count
+			 << " occurances\n";
+	}
+
+	void reset()
+	{
+		this->success_count = 0;
+		this->match_count = 0;
+	}
+};
+
+std::size_t boyermoore_list(const std::string& pattern, const std::string& text)
+{
+	std::list<int> matches;
+	boyermoore(pattern, text, matches);
+	return matches.size();
+}
+
+std::size_t boyermoore_vector(const std::string& pattern, const std::string& text)
+{
+	// Reused between calls, so its capacity is already reserved after the first few
+	static std::vector<std::size_t> matches;
+	matches.clear();
+	boyermoore_search(pattern, text, vector_sink(matches));
+	return matches.size();
+}
+
+std::size_t boyermoore_count(const std::string& pattern, const std::string& text)
+{
+	count_sink matches;
+	boyermoore_search(pattern, text, matches);
+	return matches.count;
+}
+
+std::size_t boyermoore_first(const std::string& pattern, const std::string& text)
+{
+	first_match_sink match;
+	boyermoore_search(pattern, text, match);
+	return match.found;
+}
+
+std::size_t boyermoore_callback(const std::string& pattern, const std::string& text)
+{
+	std::size_t matched = 0;
+	boyermoore_search(pattern, text, callback_sink{[&matched](std::size_t) { ++matched; }});
+	return matched;
+}
+
+std::size_t naive_list(const std::string& pattern, const std::string& text)
+{
+	std::list<int> matches;
+	naive_string_search(pattern, text, matches);
+	return matches.size();
+}
+
+std::size_t naive_count(const std::string& pattern, const std::string& text)
+{
+	count_sink matches;
+	naive_search(pattern, text, matches);
+	return matches.count;
+}
+
+#define TD_USE_INPUT
+#define TD_USE_OUTPUT
+
+#include "TestDriver.h"
+
+TD_PREPARE_INPUT
+{
+	return read_corpus_record(TD_infile, input->pattern, input->text);
+}
+
+TD_HANDLE_OUTPUT
+{
+	data->match_count += output->matched;
+	data->success_count += !!output->matched;
+}
@@ -0,0 +1,31 @@
+//----------------------------------------------------------------------
+// FILE: sinkperf.cpp
+// DESC: Driver program comparing match sinks against the original
+//       std::list<int> result path
+//----------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+#include "sink_search_tests.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	if(argc > 2)
+	{
+		std::cerr << "usage: " << argv[0] << " [filename]" << std::endl;
+		return 1;
+	}
+	// Use default file if no input file given
+	string file(argc==2 ? argv[1] : "test_in.txt");
+
+	TD_TestDriver td = TD_TestDriver("   Boyer-Moore (std::list<int>)", boyermoore_list);
+	td.add_test("      Boyer-Moore (vector_sink)", boyermoore_vector);
+	td.add_test("       Boyer-Moore (count_sink)", boyermoore_count);
+	td.add_test(" Boyer-Moore (first_match_sink)", boyermoore_first);
+	td.add_test("    Boyer-Moore (callback_sink)", boyermoore_callback);
+	td.add_test("         Naive (std::list<int>)", naive_list);
+	td.add_test("             Naive (count_sink)", naive_count);
+	td.run_tests(file);
+}
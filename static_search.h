@@ -0,0 +1,214 @@
+//----------------------------------------------------------------------
+// FILE: static_search.h
+// DESC: Boyer-Moore for patterns fixed at compile time. The shift
+//       tables are constexpr, and verification is unrolled for the
+//       pattern's length
+//----------------------------------------------------------------------
+
+#ifndef STATIC_SEARCH_H
+#define STATIC_SEARCH_H
+
+#include <string>
+#include <array>
+#include <cstddef>
+#include <climits>
+#include "match_sinks.h"
+
+/*
+The pattern is a template argument, so every table is computed by the compiler and the
+search contains no preprocessing at all. In C++17 the pattern has to be a named array with
+static storage, since string literals cannot be template arguments:
+
+	static constexpr char ERROR_PATTERN[] = "ERROR";
+	static_search<ERROR_PATTERN>(text, sink);
+
+From C++20 the literal can be written in place, static_search<"ERROR">(text, sink).
+
+The tables are the classic (Knuth-Morris-Pratt strength) Boyer-Moore ones: a bad
+character table of last occurances, and a good suffix table built from the lengths of
+the longest suffixes of the pattern ending at each position, which covers both the
+matched-suffix and the prefix cases of the good suffix rule.
+
+Reference
+- C. Charras and T. Lecroq, "Handbook of Exact String Matching Algorithms", 2004,
+  chapter "Boyer-Moore algorithm"
+*/
+
+constexpr std::ptrdiff_t static_pattern_length(const char* pattern)
+{
+	std::ptrdiff_t length = 0;
+	while(pattern[length]) ++length;
+	return length;
+}
+
+/**
+ * Shift for each text character under the last pattern position: its distance from the
+ * end of pattern[0...m-2], or m if it does not occur there
+ */
+template<std::ptrdiff_t M>
+constexpr std::array<int, UCHAR_MAX + 1> static_bad_character_table(const char* pattern)
+{
+	std::array<int, UCHAR_MAX + 1> table{};
+	for(auto& shift : table) shift = M;
+	for(std::ptrdiff_t index = 0; index < M - 1; ++index) table[(unsigned char)pattern[index]] = M - 1 - index;
+	return table;
+}
+
+/**
+ * Length of the longest suffix of pattern[0...i] that is also a suffix of the pattern,
+ * for every i
+ */
+template<std::ptrdiff_t M>
+constexpr std::array<int, M> static_suffix_table(const char* pattern)
+{
+	std::array<int, M> suffixes{};
+	suffixes[M - 1] = M;
+	std::ptrdiff_t start = M - 1, end = M - 1;
+	for(std::ptrdiff_t index = M - 2; index >= 0; --index)
+	{
+		if(index > start && suffixes[index + M - 1 - end] < index - start)
+		{
+			suffixes[index] = suffixes[index + M - 1 - end];
+			continue;
+		}
+		if(index < start) start = index;
+		end = index;
+		while(start >= 0 && pattern[start] == pattern[start + M - 1 - end]) --start;
+		suffixes[index] = end - start;
+	}
+	return suffixes;
+}
+
+/**
+ * Shift after a mismatch at each pattern position, by the good suffix rule
+ */
+template<std::ptrdiff_t M>
+constexpr std::array<int, M> static_good_suffix_table(const char* pattern)
+{
+	const std::array<int, M> suffixes = static_suffix_table<M>(pattern);
+	std::array<int, M> table{};
+	for(auto& shift : table) shift = M;
+	// Matched suffixes with a prefix of the pattern as their longest border
+	std::ptrdiff_t next = 0;
+	for(std::ptrdiff_t index = M - 1; index >= 0; --index)
+	{
+		if(suffixes[index] != index + 1) continue;
+		for(; next < M - 1 - index; ++next)
+		{
+			if(table[next] == M) table[next] = M - 1 - index;
+		}
+	}
+	// Matched suffixes that occur again further left
+	for(std::ptrdiff_t index = 0; index < M - 1; ++index) table[M - 1 - suffixes[index]] = M - 1 - index;
+	return table;
+}
+
+/**
+ * The compile-time half of the search for the pattern Literal::chars
+ */
+template<typename Literal>
+struct static_pattern
+{
+	static constexpr const char* chars = Literal::chars;
+	static constexpr std::ptrdiff_t length = static_pattern_length(chars);
+	static_assert(length > 0, "static_search needs a non-empty pattern");
+
+	static constexpr std::array<int, UCHAR_MAX + 1> bad_character = static_bad_character_table<length>(chars);
+	static constexpr std::array<int, length> good_suffix = static_good_suffix_table<length>(chars);
+
+	/**
+	 * Compares the window against the pattern from pattern[INDEX] down to pattern[0], and
+	 * returns the index of the first mismatch, or -1 for a match. Each step compares with
+	 * a constant, and the recursion unrolls into straight-line code
+	 */
+	template<std::ptrdiff_t INDEX>
+	static std::ptrdiff_t mismatch(const unsigned char* window)
+	{
+		if constexpr(INDEX < 0)
+		{
+			return -1;
+		} else {
+			if(window[INDEX] != (unsigned char)chars[INDEX]) return INDEX;
+			return mismatch<INDEX - 1>(window);
+		}
+	}
+};
+
+/**
+ * Literal wrapper for a pattern passed as a pointer to a static array
+ */
+template<const char* PATTERN>
+struct static_array_literal
+{
+	static constexpr const char* chars = PATTERN;
+};
+
+/**
+ * Boyer-Moore search of text for the pattern Literal::chars, reporting matches to sink.
+ * Returns true if there were any
+ */
+template<typename Literal, typename Sink>
+bool static_pattern_search(const std::string& text, Sink&& sink)
+{
+	using pattern = static_pattern<Literal>;
+	constexpr std::ptrdiff_t pattern_length = pattern::length;
+	const unsigned char* text_bytes = reinterpret_cast<const unsigned char*>(text.c_str());
+	const std::ptrdiff_t text_length = text.length();
+
+	bool found = false;
+	for(std::ptrdiff_t alignment = 0; alignment <= text_length - pattern_length;)
+	{
+		const std::ptrdiff_t index = pattern::template mismatch<pattern_length - 1>(text_bytes + alignment);
+		if(index < 0)
+		{
+			/***  MATCH  ***/
+			found = true;
+			if(!report_match(sink, alignment)) break;
+			alignment += pattern::good_suffix[0];
+			continue;
+		}
+		const std::ptrdiff_t bad_character_shift = pattern::bad_character[text_bytes[alignment + index]] - (pattern_length - 1 - index);
+		const std::ptrdiff_t good_suffix_shift = pattern::good_suffix[index];
+		alignment += good_suffix_shift > bad_character_shift ? good_suffix_shift : bad_character_shift;
+	}
+	return found;
+}
+
+#if __cplusplus > 201703L
+/**
+ * A string literal usable as a template argument, for static_search<"...">()
+ */
+template<std::size_t N>
+struct static_fixed_string
+{
+	constexpr static_fixed_string(const char (&literal)[N])
+	{
+		for(std::size_t index = 0; index < N; ++index) this->chars[index] = literal[index];
+	}
+
+	char chars[N] = {};
+};
+
+template<static_fixed_string STRING>
+struct static_string_literal
+{
+	static constexpr const char* chars = STRING.chars;
+};
+
+template<static_fixed_string STRING, typename Sink>
+bool static_search(const std::string& text, Sink&& sink)
+{
+	return static_pattern_search<static_string_literal<STRING>>(text, sink);
+}
+#else
+// Before C++20 the pattern has to be a constexpr char array with static storage duration.
+// From C++20 such an array converts to static_fixed_string above, and a second overload
+// taking const char* would make every call ambiguous
+template<const char* PATTERN, typename Sink>
+bool static_search(const std::string& text, Sink&& sink)
+{
+	return static_pattern_search<static_array_literal<PATTERN>>(text, sink);
+}
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+//----------------------------------------------------------------------
+// FILE: staticperf.cpp
+// DESC: Driver program comparing compile-time specialized search for
+//       fixed patterns against runtime Boyer-Moore for the same ones
+//----------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+// Search engines come before the test configuration, since TestDriver defines macros
+// (input, output, data) that would clash with names in the headers they include
+#include "static_search.h"
+#include "sink_search_tests.h"
+
+using namespace std;
+
+// The fixed patterns. Every function searches the corpus texts for one of these and
+// ignores the pattern of the record
+static constexpr char SHORT_PATTERN[] = "[a]";
+static constexpr char LONG_PATTERN[] = "Do not throw the baby";
+
+std::size_t boyermoore_short(const std::string&, const std::string& text)
+{
+	count_sink matches;
+	boyermoore_search(SHORT_PATTERN, text, matches);
+	return matches.count;
+}
+
+std::size_t static_short(const std::string&, const std::string& text)
+{
+	count_sink matches;
+	static_search<SHORT_PATTERN>(text, matches);
+	return matches.count;
+}
+
+std::size_t boyermoore_long(const std::string&, const std::string& text)
+{
+	count_sink matches;
+	boyermoore_search(LONG_PATTERN, text, matches);
+	return matches.count;
+}
+
+std::size_t static_long(const std::string&, const std::string& text)
+{
+	count_sink matches;
+	static_search<LONG_PATTERN>(text, matches);
+	return matches.count;
+}
+
+int main(int argc, char* argv[])
+{
+	if(argc > 2)
+	{
+		std::cerr << "usage: " << argv[0] << " [filename]" << std::endl;
+		return 1;
+	}
+	// Use default file if no input file given
+	string file(argc==2 ? argv[1] : "test_in.txt");
+
+	TD_TestDriver td = TD_TestDriver("    Boyer-Moore (\"[a]\", runtime)", boyermoore_short);
+	td.add_test("       Static (\"[a]\", constexpr)", static_short);
+	td.add_test(" Boyer-Moore (21 bytes, runtime)", boyermoore_long);
+	td.add_test("    Static (21 bytes, constexpr)", static_long);
+	td.run_tests(file);
+}
@@ -0,0 +1,142 @@
+#include <string>
+#include <list>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <cstdint>
+#include <unistd.h>
+#include "test_driver_decls.h"
+#include "search_corpus.h"
+#include "boyermoore.h"
+#include "streaming_search.h"
+
+// Harness configuration for streaming search. Texts are never loaded by the harness; each
+// input only records where its text lives in the corpus file, and the function under test
+// reads it from there the way it would read a log file
+
+#define TD_ARGS input->pattern, input->source
+#define TD_RETURN_TO output->matched
+#define TD_POST_TIMER output->bytes = input->source.length; output->elapsed = time;
+#define TD_INPUT StreamSearch
+#define TD_OUTPUT Results
+#define TD_DATA Metrics
+
+// Descriptor of the corpus file. The driver program opens it before run_tests()
+int stream_corpus_fd = -1;
+
+struct text_source
+{
+	int fd;
+	std::uint64_t offset;
+	std::uint64_t length;
+};
+struct StreamSearch : TD_TestInput
+{
+	std::string pattern;
+	text_source source;
+};
+struct Results : TD_TestOutput
+{
+	std::uint64_t matched;
+	std::uint64_t bytes;
+	std::chrono::nanoseconds elapsed;
+};
+
+TD_EXTEND
+struct Metrics : TD_TestMetricsBase
+{
+	TD_METRICS(Metrics)
+	{}
+
+	std::uint64_t match_count = 0;
+	int success_count = 0;
+	std::uint64_t bytes_searched = 0;
+	std::chrono::nanoseconds search_elapsed{0};
+
+	void print_result() const
+	{
+		using namespace std;
+		if(!this->success_count && this->match_count) return;
+
+		cout << "  Search" << " Found....: " << this->success_count << '\n';
+		cout << "  Search" << " Matches..: " << this->match_count
+			 << " occurances\n";
+		cout << "  Search" << " Bytes....: " << this->bytes_searched << '\n';
+		cout << " Through" << "put.......: " << (1000.0 * this->bytes_searched) / this->search_elapsed.count()
+			 << " MB/s\n";
+	}
+
+	void reset()
+	{
+		this->success_count = 0;
+		this->match_count = 0;
+		this->bytes_searched = 0;
+		this->search_elapsed = std::chrono::nanoseconds(0);
+	}
+};
+
+/**
+ * Streams the text through boyermoore_stream CHUNK_SIZE bytes at a time, from caller
+ * owned buffers
+ */
+template<std::size_t CHUNK_SIZE>
+std::uint64_t boyermoore_chunked(const std::string& pattern, const text_source& source)
+{
+	boyermoore_stream search(pattern);
+	std::vector<char> buffer(CHUNK_SIZE);
+	std::uint64_t matched = 0;
+	for(std::uint64_t done = 0; done < source.length;)
+	{
+		const std::size_t wanted = source.length - done < CHUNK_SIZE ? source.length - done : CHUNK_SIZE;
+		const ssize_t got = pread(source.fd, &buffer[0], wanted, source.offset + done);
+		if(got <= 0) break;
+		search.feed(&buffer[0], got, [&matched](std::uint64_t) { ++matched; });
+		done += got;
+	}
+	return matched;
+}
+
+/**
+ * Streams the text through boyermoore_stream by mapping WINDOW_SIZE bytes of the corpus
+ * file at a time
+ */
+template<std::size_t WINDOW_SIZE>
+std::uint64_t boyermoore_mapped(const std::string& pattern, const text_source& source)
+{
+	boyermoore_stream search(pattern);
+	std::uint64_t matched = 0;
+	search_mapped(search, source.fd, source.offset, source.length, WINDOW_SIZE, [&matched](std::uint64_t) { ++matched; });
+	return matched;
+}
+
+/**
+ * Baseline: loads the whole text into memory, then calls boyermoore()
+ */
+std::uint64_t boyermoore_loaded(const std::string& pattern, const text_source& source)
+{
+	std::string text(source.length, '\0');
+	if(pread(source.fd, &text[0], source.length, source.offset) != ssize_t(source.length)) return 0;
+	std::list<int> matches;
+	boyermoore(pattern, text, matches);
+	return matches.size();
+}
+
+#define TD_USE_INPUT
+#define TD_USE_OUTPUT
+
+#include "TestDriver.h"
+
+TD_PREPARE_INPUT
+{
+	if(!read_corpus_field(TD_infile, input->pattern)) return false;
+	input->source.fd = stream_corpus_fd;
+	return skip_corpus_field(TD_infile, input->source.offset, input->source.length);
+}
+
+TD_HANDLE_OUTPUT
+{
+	data->match_count += output->matched;
+	data->success_count += !!output->matched;
+	data->bytes_searched += output->bytes;
+	data->search_elapsed += output->elapsed;
+}
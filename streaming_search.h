@@ -0,0 +1,169 @@
+//----------------------------------------------------------------------
+// FILE: streaming_search.h
+// DESC: Boyer-Moore (Apostolico-Giancarlo) search over a text that
+//       arrives in chunks, in constant memory
+//----------------------------------------------------------------------
+
+#ifndef STREAMING_SEARCH_H
+#define STREAMING_SEARCH_H
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include "boyermoore.h"
+
+/**
+ * Searches a stream of unbounded length for one pattern. The stream is handed over one
+ * chunk at a time with feed(), and matches are reported with their absolute 64-bit offset
+ * from the start of the stream.
+ *
+ * Chunks are searched in place. The only state kept between chunks is the last
+ * pattern_length-1 bytes of the stream and the Apostolico-Giancarlo ring, so memory use
+ * depends on the pattern length alone. Alignments that straddle a chunk boundary are
+ * searched in a stitched buffer of at most 2*(pattern_length-1) bytes: the carried bytes
+ * followed by the start of the new chunk.
+ */
+class boyermoore_stream
+{
+public:
+	explicit boyermoore_stream(const std::string& pattern)
+	: pattern(pattern)
+	, pattern_length(pattern.length())
+	, apostolico_giancarlo_skip(pattern.length())
+	{
+		if(pattern_length >= 2) this->compiled.emplace(pattern);
+		this->reset();
+	}
+
+	/**
+	 * Searches the next length bytes of the stream, calling report(offset) for every match
+	 * that ends inside them. chunk only needs to stay valid for the duration of the call
+	 */
+	template<typename Report>
+	void feed(const char* chunk, std::size_t length, Report&& report);
+
+	// Starts over at offset 0 of a new stream
+	void reset()
+	{
+		this->carry.clear();
+		this->apostolico_giancarlo_skip.reset();
+		this->stream_position = 0;
+		this->next_alignment = this->pattern_length ? this->pattern_length - 1 : 0;
+	}
+
+	// Number of bytes of the stream searched so far
+	std::uint64_t position() const { return this->stream_position; }
+private:
+	std::string pattern;
+	std::size_t pattern_length;
+	std::optional<boyermoore_pattern> compiled;
+	apostolico_giancarlo_ring apostolico_giancarlo_skip;
+	// Last pattern_length-1 bytes of the stream, and scratch space for stitching them to
+	// the start of the next chunk
+	std::string carry;
+	std::string stitch;
+	std::uint64_t stream_position;
+	// Absolute offset of the last character of the next alignment to check
+	std::uint64_t next_alignment;
+};
+
+template<typename Report>
+void boyermoore_stream::feed(const char* chunk, std::size_t length, Report&& report)
+{
+	const std::uint64_t chunk_position = this->stream_position;
+	this->stream_position += length;
+	if(!this->pattern_length) return;
+	// The same special case boyermoore() makes, there is nothing to carry
+	if(this->pattern_length == 1)
+	{
+		for(const char* found = chunk; (found = (const char*)std::memchr(found, this->pattern[0], chunk + length - found)); ++found)
+		{
+			report(chunk_position + (found - chunk));
+		}
+		return;
+	}
+
+	const std::size_t overlap = this->pattern_length - 1;
+	if(!this->carry.empty())
+	{
+		// Alignments that start in the carried bytes
+		const std::uint64_t stitch_position = chunk_position - this->carry.length();
+		this->stitch.assign(this->carry);
+		this->stitch.append(chunk, length < overlap ? length : overlap);
+		this->apostolico_giancarlo_skip.rebase(stitch_position);
+		this->next_alignment = stitch_position + boyermoore_scan(*this->compiled, this->apostolico_giancarlo_skip,
+			this->stitch.c_str(), this->stitch.length(), this->next_alignment - stitch_position,
+			[&](std::ptrdiff_t match) { report(stitch_position + match); });
+	}
+	if(this->next_alignment < this->stream_position)
+	{
+		// Alignments entirely inside the chunk
+		this->apostolico_giancarlo_skip.rebase(chunk_position);
+		this->next_alignment = chunk_position + boyermoore_scan(*this->compiled, this->apostolico_giancarlo_skip,
+			chunk, length, this->next_alignment - chunk_position,
+			[&](std::ptrdiff_t match) { report(chunk_position + match); });
+	}
+
+	if(length >= overlap)
+	{
+		this->carry.assign(chunk + length - overlap, overlap);
+	} else {
+		this->carry.append(chunk, length);
+		if(this->carry.length() > overlap) this->carry.erase(0, this->carry.length() - overlap);
+	}
+}
+
+/**
+ * Streams everything readable from fd through search, chunk_size bytes at a time.
+ * Returns false if a read fails, in which case matches up to that point have already
+ * been reported
+ */
+template<typename Report>
+bool search_fd(boyermoore_stream& search, int fd, std::size_t chunk_size, Report&& report)
+{
+	std::vector<char> buffer(chunk_size);
+	for(;;)
+	{
+		const ssize_t got = read(fd, &buffer[0], buffer.size());
+		if(got < 0 && errno == EINTR) continue;
+		if(got < 0) return false;
+		if(!got) return true;
+		search.feed(&buffer[0], got, report);
+	}
+}
+
+/**
+ * Streams length bytes of fd, starting at offset, through search by mapping the file
+ * window_size bytes at a time. Nothing is copied; each window is unmapped before the next
+ * is mapped. Returns false if a window cannot be mapped
+ */
+template<typename Report>
+bool search_mapped(boyermoore_stream& search, int fd, std::uint64_t offset, std::uint64_t length, std::size_t window_size, Report&& report)
+{
+	const std::uint64_t page_size = sysconf(_SC_PAGESIZE);
+	// Windows must start on a page boundary
+	window_size = (window_size + page_size - 1) / page_size * page_size;
+	const std::uint64_t end = offset + length;
+	std::uint64_t map_position = offset / page_size * page_size;
+	while(offset < end)
+	{
+		const std::size_t map_length = end - map_position < window_size ? end - map_position : window_size;
+		void* window = mmap(nullptr, map_length, PROT_READ, MAP_PRIVATE, fd, map_position);
+		if(window == MAP_FAILED) return false;
+		madvise(window, map_length, MADV_SEQUENTIAL);
+		const std::size_t skipped = offset - map_position;
+		search.feed((const char*)window + skipped, map_length - skipped, report);
+		munmap(window, map_length);
+		map_position += map_length;
+		offset = map_position;
+	}
+	return true;
+}
+
+#endif
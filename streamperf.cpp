@@ -0,0 +1,38 @@
+//----------------------------------------------------------------------
+// FILE: streamperf.cpp
+// DESC: Driver program measuring streaming Boyer-Moore throughput at
+//       different chunk sizes
+//----------------------------------------------------------------------
+
+#include <string>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "stream_search_tests.h"
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+	if(argc > 2)
+	{
+		std::cerr << "usage: " << argv[0] << " [filename]" << std::endl;
+		return 1;
+	}
+	// Use default file if no input file given
+	string file(argc==2 ? argv[1] : "test_in.txt");
+	stream_corpus_fd = open(file.c_str(), O_RDONLY);
+	if(stream_corpus_fd < 0)
+	{
+		std::cerr << argv[0] << ": cannot open " << file << std::endl;
+		return 1;
+	}
+
+	TD_TestDriver td = TD_TestDriver("       Boyer-Moore (whole text)", boyermoore_loaded);
+	td.add_test("       Streaming (4 KiB chunks)", boyermoore_chunked<4 << 10>);
+	td.add_test("      Streaming (64 KiB chunks)", boyermoore_chunked<64 << 10>);
+	td.add_test("       Streaming (1 MiB chunks)", boyermoore_chunked<1 << 20>);
+	td.add_test(" Streaming (1 MiB mmap windows)", boyermoore_mapped<1 << 20>);
+	td.run_tests(file);
+	close(stream_corpus_fd);
+}
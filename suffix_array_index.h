@@ -0,0 +1,339 @@
+//----------------------------------------------------------------------
+// FILE: suffix_array_index.h
+// DESC: Suffix array index of a text, built once with SA-IS and queried
+//       for any number of patterns in O(m log n). Indexes can be saved
+//       to a file and memory-mapped back in place of a rebuild
+//----------------------------------------------------------------------
+
+#ifndef SUFFIX_ARRAY_INDEX_H
+#define SUFFIX_ARRAY_INDEX_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <fstream>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "match_sinks.h"
+#include "parallel_search.h"
+
+/**
+ * Suffix array of s, whose characters are in [0, upper], by induced sorting (SA-IS):
+ * classify suffixes as S or L type, sort the LMS substrings by inducing from their buckets,
+ * name them, recurse on the names if any are equal, then induce the full order from the
+ * sorted LMS suffixes. O(n) time, and O(n) extra space on top of the result.
+ *
+ * References
+ * - G. Nong, S. Zhang and W. H. Chan, "Two efficient algorithms for linear time suffix
+ *   array construction", IEEE Trans. Computers 60(10), 2011
+ * - https://github.com/atcoder/ac-library/blob/master/atcoder/string.hpp
+ */
+std::vector<int> sa_is(const std::vector<int>& s, int upper)
+{
+	const int n = s.size();
+	if(n == 0) return {};
+	if(n == 1) return {0};
+	if(n == 2) return s[0] < s[1] ? std::vector<int>{0, 1} : std::vector<int>{1, 0};
+
+	std::vector<int> sa(n);
+	// is_s[i] is true when suffix i is S type, smaller than suffix i+1
+	std::vector<bool> is_s(n);
+	for(int i = n - 2; i >= 0; --i) is_s[i] = s[i] == s[i + 1] ? is_s[i + 1] : s[i] < s[i + 1];
+
+	// Bucket boundaries: sum_l[c] is where the L type suffixes starting with c begin, and
+	// sum_s[c] where the S type ones do
+	std::vector<int> sum_l(upper + 1), sum_s(upper + 1);
+	for(int i = 0; i < n; ++i)
+	{
+		if(!is_s[i]) ++sum_s[s[i]];
+		else ++sum_l[s[i] + 1];
+	}
+	for(int c = 0; c <= upper; ++c)
+	{
+		sum_s[c] += sum_l[c];
+		if(c < upper) sum_l[c + 1] += sum_s[c];
+	}
+
+	auto induce = [&](const std::vector<int>& lms)
+	{
+		std::fill(sa.begin(), sa.end(), -1);
+		std::vector<int> bucket(sum_s);
+		for(int suffix : lms)
+		{
+			if(suffix != n) sa[bucket[s[suffix]]++] = suffix;
+		}
+		bucket = sum_l;
+		sa[bucket[s[n - 1]]++] = n - 1;
+		for(int i = 0; i < n; ++i)
+		{
+			const int suffix = sa[i];
+			if(suffix >= 1 && !is_s[suffix - 1]) sa[bucket[s[suffix - 1]]++] = suffix - 1;
+		}
+		bucket = sum_l;
+		for(int i = n - 1; i >= 0; --i)
+		{
+			const int suffix = sa[i];
+			if(suffix >= 1 && is_s[suffix - 1]) sa[--bucket[s[suffix - 1] + 1]] = suffix - 1;
+		}
+	};
+
+	// LMS positions, the S type suffixes preceded by an L type one, and their ranks
+	std::vector<int> lms_index(n + 1, -1);
+	std::vector<int> lms;
+	for(int i = 1; i < n; ++i)
+	{
+		if(is_s[i - 1] || !is_s[i]) continue;
+		lms_index[i] = lms.size();
+		lms.push_back(i);
+	}
+	const int lms_count = lms.size();
+	induce(lms);
+	if(!lms_count) return sa;
+
+	// Name the LMS substrings in sorted order, equal substrings getting equal names
+	std::vector<int> sorted_lms;
+	sorted_lms.reserve(lms_count);
+	for(int suffix : sa)
+	{
+		if(lms_index[suffix] != -1) sorted_lms.push_back(suffix);
+	}
+	std::vector<int> names(lms_count);
+	int name = 0;
+	names[lms_index[sorted_lms[0]]] = 0;
+	for(int i = 1; i < lms_count; ++i)
+	{
+		int left = sorted_lms[i - 1], right = sorted_lms[i];
+		const int left_end = lms_index[left] + 1 < lms_count ? lms[lms_index[left] + 1] : n;
+		const int right_end = lms_index[right] + 1 < lms_count ? lms[lms_index[right] + 1] : n;
+		bool same = left_end - left == right_end - right;
+		if(same)
+		{
+			for(; left < left_end && s[left] == s[right]; ++left, ++right);
+			if(left == n || s[left] != s[right]) same = false;
+		}
+		if(!same) ++name;
+		names[lms_index[sorted_lms[i]]] = name;
+	}
+
+	// Sorting the names sorts the LMS suffixes
+	const std::vector<int> named_sa = sa_is(names, name);
+	for(int i = 0; i < lms_count; ++i) sorted_lms[i] = lms[named_sa[i]];
+	induce(sorted_lms);
+	return sa;
+}
+
+/**
+ * A text together with its suffix array. All occurances of a pattern are next to each
+ * other in suffix array order, so a query is two binary searches for the ends of that
+ * range, O(m log n) character comparisons, no matter how often the pattern occurs.
+ *
+ * The index either owns its arrays, when built from a text, or points into a read-only
+ * mapping of a file written by save(). Texts are limited to INT32_MAX bytes so that
+ * suffix array entries are 4 bytes; building from a longer text throws std::length_error
+ */
+class suffix_array_index
+{
+public:
+	explicit suffix_array_index(const std::string& text);
+	~suffix_array_index();
+
+	suffix_array_index(const suffix_array_index&) = delete;
+	suffix_array_index& operator=(const suffix_array_index&) = delete;
+
+	/**
+	 * Maps an index written by save(). Returns nullptr if the file cannot be mapped or was
+	 * not written by save()
+	 */
+	static std::unique_ptr<suffix_array_index> map(const std::string& filename);
+
+	/**
+	 * Writes the text and suffix array to filename, laid out so map() can use the file
+	 * as is. Returns false on failure
+	 */
+	bool save(const std::string& filename) const;
+
+	/**
+	 * Reports every occurance of pattern to sink in increasing offset order, and returns
+	 * true if there were any
+	 */
+	template<typename Sink>
+	bool search(const std::string& pattern, Sink&& sink) const;
+
+	std::size_t count(const std::string& pattern) const;
+
+	std::size_t text_length() const { return this->length; }
+	const char* text() const { return this->text_chars; }
+	// Bytes of memory holding the text and suffix array
+	std::size_t memory_bytes() const { return this->length * (1 + sizeof(std::int32_t)); }
+	bool mapped() const { return this->mapping; }
+private:
+	suffix_array_index() = default;
+
+	// Range [first, last) of the suffix array whose suffixes start with pattern
+	void find(const std::string& pattern, std::size_t& first, std::size_t& last) const;
+	// Compares the start of a suffix with pattern, treating a suffix shorter than pattern
+	// that is a prefix of it as smaller
+	int compare(std::int32_t suffix, const std::string& pattern) const;
+
+	static constexpr char MAGIC[8] = {'S', 'A', 'I', 'N', 'D', 'E', 'X', '1'};
+	static constexpr std::size_t HEADER_LENGTH = sizeof(MAGIC) + sizeof(std::uint64_t);
+	// Offset of the suffix array in a saved index, after the text padded to 8 bytes
+	static std::size_t suffixes_offset(std::size_t length)
+	{
+		return HEADER_LENGTH + ((length + 7) & ~std::size_t(7));
+	}
+
+	std::string text_storage;
+	std::vector<std::int32_t> suffix_storage;
+	const char* text_chars = nullptr;
+	const std::int32_t* suffixes = nullptr;
+	std::size_t length = 0;
+	void* mapping = nullptr;
+	std::size_t mapping_length = 0;
+};
+
+suffix_array_index::suffix_array_index(const std::string& text)
+: text_storage(text.length() <= INT32_MAX ? text : throw std::length_error("suffix_array_index: text longer than INT32_MAX bytes"))
+{
+	std::vector<int> bytes(this->text_storage.length());
+	for(std::size_t i = 0; i < bytes.size(); ++i) bytes[i] = (unsigned char)this->text_storage[i];
+	const std::vector<int> sa = sa_is(bytes, UCHAR_MAX);
+	this->suffix_storage.assign(sa.begin(), sa.end());
+	this->text_chars = this->text_storage.c_str();
+	this->suffixes = this->suffix_storage.empty() ? nullptr : &this->suffix_storage[0];
+	this->length = this->text_storage.length();
+}
+
+suffix_array_index::~suffix_array_index()
+{
+	if(this->mapping) munmap(this->mapping, this->mapping_length);
+}
+
+std::unique_ptr<suffix_array_index> suffix_array_index::map(const std::string& filename)
+{
+	const int fd = open(filename.c_str(), O_RDONLY);
+	if(fd < 0) return nullptr;
+	struct stat status;
+	void* mapping = MAP_FAILED;
+	if(!fstat(fd, &status) && std::size_t(status.st_size) >= HEADER_LENGTH)
+	{
+		mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	if(mapping == MAP_FAILED) return nullptr;
+
+	std::unique_ptr<suffix_array_index> index(new suffix_array_index());
+	index->mapping = mapping;
+	index->mapping_length = status.st_size;
+	const char* file = static_cast<const char*>(mapping);
+	std::uint64_t length;
+	std::memcpy(&length, file + sizeof(MAGIC), sizeof(length));
+	if(std::memcmp(file, MAGIC, sizeof(MAGIC)) || length > INT32_MAX
+		|| index->mapping_length != suffixes_offset(length) + length * sizeof(std::int32_t))
+	{
+		return nullptr;
+	}
+	index->text_chars = file + HEADER_LENGTH;
+	index->suffixes = reinterpret_cast<const std::int32_t*>(file + suffixes_offset(length));
+	index->length = length;
+	return index;
+}
+
+bool suffix_array_index::save(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios::binary);
+	const std::uint64_t length = this->length;
+	out.write(MAGIC, sizeof(MAGIC));
+	out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+	out.write(this->text_chars, this->length);
+	const char padding[8] = {};
+	out.write(padding, suffixes_offset(this->length) - HEADER_LENGTH - this->length);
+	out.write(reinterpret_cast<const char*>(this->suffixes), this->length * sizeof(std::int32_t));
+	return !!out;
+}
+
+int suffix_array_index::compare(std::int32_t suffix, const std::string& pattern) const
+{
+	const std::size_t available = this->length - suffix;
+	const std::size_t compared = available < pattern.length() ? available : pattern.length();
+	const int order = std::memcmp(this->text_chars + suffix, pattern.c_str(), compared);
+	if(order) return order;
+	return compared < pattern.length() ? -1 : 0;
+}
+
+void suffix_array_index::find(const std::string& pattern, std::size_t& first, std::size_t& last) const
+{
+	// First suffix not less than the pattern
+	std::size_t low = 0, high = this->length;
+	while(low < high)
+	{
+		const std::size_t middle = low + (high - low) / 2;
+		if(this->compare(this->suffixes[middle], pattern) < 0) low = middle + 1;
+		else high = middle;
+	}
+	first = low;
+	// First suffix greater than the pattern, which starts no earlier
+	high = this->length;
+	while(low < high)
+	{
+		const std::size_t middle = low + (high - low) / 2;
+		if(this->compare(this->suffixes[middle], pattern) <= 0) low = middle + 1;
+		else high = middle;
+	}
+	last = low;
+}
+
+template<typename Sink>
+bool suffix_array_index::search(const std::string& pattern, Sink&& sink) const
+{
+	if(pattern.empty()) return true;
+	std::size_t first, last;
+	this->find(pattern, first, last);
+	if(first == last) return false;
+	// Suffix array order is lexicographic, so the offsets have to be sorted
+	std::vector<std::int32_t> offsets(this->suffixes + first, this->suffixes + last);
+	std::sort(offsets.begin(), offsets.end());
+	for(std::int32_t offset : offsets)
+	{
+		if(!report_match(sink, offset)) break;
+	}
+	return true;
+}
+
+std::size_t suffix_array_index::count(const std::string& pattern) const
+{
+	if(pattern.empty()) return 0;
+	std::size_t first, last;
+	this->find(pattern, first, last);
+	return last - first;
+}
+
+/**
+ * Builds an index for every text on the threads of pool. SA-IS itself is sequential, so the
+ * parallelism is across texts, one index per task. Throws std::length_error, before any
+ * task starts, if a text is too long to be indexed
+ */
+std::vector<std::unique_ptr<suffix_array_index>> build_suffix_array_indexes(const std::vector<std::string>& texts, search_thread_pool& pool)
+{
+	// Checked here, since an exception must not escape a task on a pool thread
+	for(const std::string& text : texts)
+	{
+		if(text.length() > INT32_MAX) throw std::length_error("suffix_array_index: text longer than INT32_MAX bytes");
+	}
+	std::vector<std::unique_ptr<suffix_array_index>> indexes(texts.size());
+	pool.run(texts.size(), [&](std::size_t text)
+	{
+		indexes[text].reset(new suffix_array_index(texts[text]));
+	});
+	return indexes;
+}
+
+#endif
@@ -0,0 +1,66 @@
+//----------------------------------------------------------------------
+// FILE: sunday.h
+// DESC: Sunday's Quick Search, a Horspool variant keyed on the text
+//       character just past the current alignment
+//----------------------------------------------------------------------
+
+#ifndef SUNDAY_H
+#define SUNDAY_H
+
+#include <string>
+#include <list>
+#include <cstddef>
+#include <cstring>
+#include <climits>
+#include "match_sinks.h"
+
+/**
+ * Quick Search. The text character just past the alignment has to line up with the pattern
+ * after any shift, so the shift is how far that character is from its last occurance in
+ * the whole pattern, or m + 1 if it is not there. The shifts are one longer than
+ * Horspool's for the same table, at the cost of reading one character outside the window.
+ *
+ * References
+ * - D. M. Sunday, "A very fast substring search algorithm", Commun. ACM 33(8), 1990
+ */
+template<typename Sink>
+bool sunday_search(const std::string& pattern, const std::string& text, Sink&& sink)
+{
+	const std::size_t text_length = text.length();
+	const std::size_t pattern_length = pattern.length();
+	if(text_length < pattern_length) return false;
+	if(pattern_length == 0) return true;
+
+	const unsigned char* pattern_bytes = reinterpret_cast<const unsigned char*>(pattern.c_str());
+	const unsigned char* text_bytes = reinterpret_cast<const unsigned char*>(text.c_str());
+
+	std::size_t shift_table[UCHAR_MAX + 1];
+	for(auto& shift : shift_table) shift = pattern_length + 1;
+	for(std::size_t index = 0; index < pattern_length; ++index)
+	{
+		shift_table[pattern_bytes[index]] = pattern_length - index;
+	}
+
+	bool found = false;
+	const std::size_t last_alignment = text_length - pattern_length;
+	for(std::size_t alignment = 0; alignment <= last_alignment;)
+	{
+		if(!std::memcmp(pattern_bytes, text_bytes + alignment, pattern_length))
+		{
+			/***  MATCH  ***/
+			found = true;
+			if(!report_match(sink, alignment)) break;
+		}
+		// The last alignment has no character after it
+		if(alignment == last_alignment) break;
+		alignment += shift_table[text_bytes[alignment + pattern_length]];
+	}
+	return found;
+}
+
+bool sunday(const std::string& pattern, const std::string& text, std::list<int>& matches)
+{
+	return sunday_search(pattern, text, list_sink{matches});
+}
+
+#endif
@@ -0,0 +1,149 @@
+//----------------------------------------------------------------------
+// DESCRIPTION: Paired comparison of test functions, input by input,
+//              against the first registered function
+// ----------------------------------------------------------------------
+
+#ifndef __TD_COMPARE_H
+#define __TD_COMPARE_H
+
+/*
+With TD_USE_COMPARISON defined, the driver keeps the time of every function on every input
+and compares each function with the first one registered (the baseline) on the same
+inputs. For each function it reports:
+- the geometric mean of the per-input speedups over the baseline, with a 95% confidence
+  interval from the spread of the log speedups (normal approximation)
+- a two-sided Wilcoxon signed-rank test of the log speedups against 0, i.e. whether the
+  function is faster or slower on most inputs rather than just on average (normal
+  approximation with tie correction, so it needs 10 or so inputs to mean much)
+The same is repeated for each input class, the value of TD_INPUT_CLASS (a std::string
+expression of input) for the input, so that a change helping one kind of input and hurting
+another does not hide in the overall numbers.
+*/
+
+#ifdef TD_USE_COMPARISON
+#include <string>
+#include <vector>
+#include <utility>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+
+class TD_Comparison
+{
+public:
+	/**
+	 * Records one input. elapsed[f] is the time function f took on it, with the baseline
+	 * first. Inputs that any function ran in no measurable time are skipped
+	 */
+	void add(const std::string& input_class, const std::vector<long long>& elapsed)
+	{
+		for(long long time : elapsed)
+		{
+			if(time <= 0) return;
+		}
+		this->record(this->overall, elapsed);
+		auto found = std::find_if(this->classes.begin(), this->classes.end(),
+			[&input_class](const auto& known) { return known.first == input_class; });
+		if(found == this->classes.end())
+		{
+			this->classes.emplace_back(input_class, std::vector<std::vector<double>>());
+			found = this->classes.end() - 1;
+		}
+		this->record(found->second, elapsed);
+	}
+
+	void reset()
+	{
+		this->overall.clear();
+		this->classes.clear();
+	}
+
+	// names[f] is the header of function f
+	void print(const std::vector<std::string>& names) const
+	{
+		using namespace std;
+		if(names.size() < 2 || this->overall.empty()) return;
+
+		const string title = " Paired Comparison vs " + names[0];
+		cout << '\n' << title << '\n' << string(title.length(), '=') << "\n\n";
+		for(size_t function = 1; function < names.size(); ++function)
+		{
+			cout << "  " << names[function] << '\n';
+			print_line("all", this->overall[function - 1]);
+			if(this->classes.size() < 2) continue;
+			for(const auto& input_class : this->classes) print_line(input_class.first, input_class.second[function - 1]);
+		}
+		cout << endl;
+	}
+private:
+	// Appends the log speedup of every function over the baseline
+	static void record(std::vector<std::vector<double>>& log_speedups, const std::vector<long long>& elapsed)
+	{
+		if(log_speedups.size() < elapsed.size() - 1) log_speedups.resize(elapsed.size() - 1);
+		for(std::size_t function = 1; function < elapsed.size(); ++function)
+		{
+			log_speedups[function - 1].push_back(std::log(double(elapsed[0]) / elapsed[function]));
+		}
+	}
+
+	// Two-sided p-value of the Wilcoxon signed-rank test that the values are centred on 0
+	static double wilcoxon_p(const std::vector<double>& values)
+	{
+		// Magnitude of each nonzero value, and whether the value was positive
+		std::vector<std::pair<double, bool>> magnitudes;
+		for(double value : values)
+		{
+			if(value != 0) magnitudes.emplace_back(std::fabs(value), value > 0);
+		}
+		const double n = magnitudes.size();
+		if(n == 0) return 1;
+		std::sort(magnitudes.begin(), magnitudes.end());
+
+		// Sum of the ranks of the positive values, ties sharing their average rank
+		double positive_rank_sum = 0, tie_correction = 0;
+		for(std::size_t first = 0; first < magnitudes.size();)
+		{
+			std::size_t last = first;
+			while(last + 1 < magnitudes.size() && magnitudes[last + 1].first == magnitudes[first].first) ++last;
+			const double rank = (first + last) / 2.0 + 1;
+			const double ties = last - first + 1;
+			tie_correction += ties * ties * ties - ties;
+			for(std::size_t index = first; index <= last; ++index)
+			{
+				if(magnitudes[index].second) positive_rank_sum += rank;
+			}
+			first = last + 1;
+		}
+		const double mean = n * (n + 1) / 4;
+		const double variance = n * (n + 1) * (2 * n + 1) / 24 - tie_correction / 48;
+		if(variance <= 0) return 1;
+		const double z = (positive_rank_sum - mean) / std::sqrt(variance);
+		return std::erfc(std::fabs(z) / std::sqrt(2.0));
+	}
+
+	static void print_line(const std::string& label, const std::vector<double>& log_speedups)
+	{
+		using namespace std;
+		const double n = log_speedups.size();
+		double mean = 0;
+		for(double value : log_speedups) mean += value;
+		mean /= n;
+		double variance = 0;
+		for(double value : log_speedups) variance += (value - mean) * (value - mean);
+		variance = n > 1 ? variance / (n - 1) : 0;
+		const double margin = 1.96 * sqrt(variance / n);
+
+		string heading = "    " + label + " (n=" + to_string(log_speedups.size()) + ")";
+		if(heading.length() < 24) heading += string(24 - heading.length(), '.');
+		cout << heading << ": " << exp(mean) << "x speedup [95% CI " << exp(mean - margin) << "x - "
+			 << exp(mean + margin) << "x], Wilcoxon p = " << wilcoxon_p(log_speedups) << '\n';
+	}
+
+	// overall[f-1] holds the log speedups of function f on every input; classes holds the
+	// same for each input class, in order of first appearance
+	std::vector<std::vector<double>> overall;
+	std::vector<std::pair<std::string, std::vector<std::vector<double>>>> classes;
+};
+#endif // TD_USE_COMPARISON
+
+#endif // __TD_COMPARE_H
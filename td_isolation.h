@@ -0,0 +1,104 @@
+//----------------------------------------------------------------------
+// DESCRIPTION: Running each test function in a process of its own,
+//              with the resources each one used
+// ----------------------------------------------------------------------
+
+#ifndef __TD_ISOLATION_H
+#define __TD_ISOLATION_H
+
+/*
+With TD_USE_ISOLATION defined, run_tests() forks a child process for every test function and
+runs the whole input on that function alone in the child. No function inherits the heap,
+caches or page faults left behind by the functions run before it, and the child's getrusage
+counters describe that one function: peak resident set size, minor and major page faults,
+and voluntary and involuntary context switches. Each child prints its function's usual
+results with these added, then sends its counters and call totals back to the driver over a
+pipe, and the driver ends with a table of all the functions side by side.
+
+The child starts as a copy of the driver, so the peak RSS includes what the driver process
+already held at the fork; that starting size is shown as well. Reports that need every
+function's results in one process (TD_USE_COMPARISON, and harness-level summaries kept in
+globals) only see one function per child and are not meaningful in this mode.
+*/
+
+#ifdef TD_USE_ISOLATION
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+// Resources used by the process running one test function
+struct TD_ResourceUsage
+{
+	// kilobytes
+	long start_rss = 0, peak_rss = 0;
+	long minor_faults = 0, major_faults = 0;
+	long voluntary_switches = 0, involuntary_switches = 0;
+
+	// Counters of the calling process so far
+	static TD_ResourceUsage current()
+	{
+		rusage usage = {};
+		getrusage(RUSAGE_SELF, &usage);
+		TD_ResourceUsage result;
+		result.start_rss = result.peak_rss = usage.ru_maxrss;
+		result.minor_faults = usage.ru_minflt;
+		result.major_faults = usage.ru_majflt;
+		result.voluntary_switches = usage.ru_nvcsw;
+		result.involuntary_switches = usage.ru_nivcsw;
+		return result;
+	}
+
+	// Usage between start and now, with peak_rss the peak since the process started
+	static TD_ResourceUsage since(const TD_ResourceUsage& start)
+	{
+		TD_ResourceUsage result = current();
+		result.start_rss = start.peak_rss;
+		result.minor_faults -= start.minor_faults;
+		result.major_faults -= start.major_faults;
+		result.voluntary_switches -= start.voluntary_switches;
+		result.involuntary_switches -= start.involuntary_switches;
+		return result;
+	}
+
+	void print() const
+	{
+		using namespace std;
+		cout << "  Peak" << " RSS........: " << this->peak_rss << " kB (" << this->start_rss << " kB at start)\n";
+		cout << "  Page" << " Faults.....: " << this->minor_faults << " minor, " << this->major_faults << " major\n";
+		cout << "  Context" << " Switches: " << this->voluntary_switches << " voluntary, "
+			 << this->involuntary_switches << " involuntary\n";
+	}
+};
+
+// What a child sends back to the driver when its function has run
+struct TD_IsolatedResult
+{
+	int total_search = 0, search_times = 0;
+	TD_ResourceUsage usage;
+};
+
+/**
+ * Prints the usage of every isolated function, names[f] being the header of function f
+ */
+inline void TD_print_isolated_results(const std::string* names, const TD_IsolatedResult* results, std::size_t count)
+{
+	using namespace std;
+	cout << "\n Isolated Runs\n==============\n\n";
+	cout << "  " << left << setw(28) << "Function" << right << setw(12) << "Time (us)" << setw(14) << "Peak RSS (kB)"
+		 << setw(14) << "Minor Faults" << setw(14) << "Major Faults" << setw(12) << "Vol. CS" << setw(12) << "Invol. CS" << '\n';
+	for(size_t function = 0; function < count; ++function)
+	{
+		const TD_IsolatedResult& result = results[function];
+		cout << "  " << left << setw(28) << names[function] << right << setw(12) << result.search_times
+			 << setw(14) << result.usage.peak_rss << setw(14) << result.usage.minor_faults << setw(14) << result.usage.major_faults
+			 << setw(12) << result.usage.voluntary_switches << setw(12) << result.usage.involuntary_switches << '\n';
+	}
+	cout << endl;
+}
+#endif // TD_USE_ISOLATION
+
+#endif // __TD_ISOLATION_H
@@ -0,0 +1,162 @@
+//----------------------------------------------------------------------
+// DESCRIPTION: The slowest inputs of each test function, kept in
+//              bounded heaps for reporting and replay
+// ----------------------------------------------------------------------
+
+#ifndef __TD_OUTLIERS_H
+#define __TD_OUTLIERS_H
+
+/*
+With TD_USE_OUTLIERS defined, the driver keeps the TD_OUTLIER_COUNT slowest inputs of every
+function, with the input's index in the run, TD_INPUT_DESCRIPTION (a std::string expression
+of input, e.g. its sizes), and what every function took on it. The report shows how much
+slower each function was than the others on its worst inputs, which tells a pathological
+input for one engine apart from one that is simply large.
+
+Memory depends on TD_OUTLIER_COUNT and the number of functions, not on the number of inputs.
+When the inputs are read from a file one record at a time, the byte range each record came
+from is kept too, and TD_TestDriver::dump_slowest() copies those records, unchanged, into a
+new file that can be given to the same harness to replay just those inputs.
+*/
+
+#ifdef TD_USE_OUTLIERS
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#ifndef TD_OUTLIER_COUNT
+#define TD_OUTLIER_COUNT 10
+#endif // TD_OUTLIER_COUNT
+
+class TD_Outliers
+{
+public:
+	struct Record
+	{
+		long index;
+		// where the record is in the input file, or -1 if unknown. An end of -1 means the
+		// end of the file
+		std::streamoff begin, end;
+		std::string description;
+		// nanoseconds taken by each function
+		std::vector<long long> elapsed;
+	};
+
+	/**
+	 * Offers one input to the heap of every function. describe() is only called if the
+	 * input is among the slowest of some function
+	 */
+	template<typename Describe>
+	void add(long index, std::streamoff begin, std::streamoff end, Describe describe, const std::vector<long long>& elapsed)
+	{
+		if(this->slowest.size() < elapsed.size()) this->slowest.resize(elapsed.size());
+		std::string description;
+		bool described = false;
+		for(std::size_t function = 0; function < elapsed.size(); ++function)
+		{
+			std::vector<Record>& heap = this->slowest[function];
+			const auto faster = [function](const Record& left, const Record& right)
+			{
+				return left.elapsed[function] > right.elapsed[function];
+			};
+			if(heap.size() == TD_OUTLIER_COUNT)
+			{
+				if(elapsed[function] <= heap.front().elapsed[function]) continue;
+				std::pop_heap(heap.begin(), heap.end(), faster);
+				heap.pop_back();
+			}
+			if(!described)
+			{
+				description = describe();
+				described = true;
+			}
+			heap.push_back(Record{index, begin, end, description, elapsed});
+			std::push_heap(heap.begin(), heap.end(), faster);
+		}
+	}
+
+	void reset()
+	{
+		this->slowest.clear();
+	}
+
+	// names[f] is the header of function f
+	void print(const std::vector<std::string>& names) const
+	{
+		using namespace std;
+		for(size_t function = 0; function < this->slowest.size() && function < names.size(); ++function)
+		{
+			vector<Record> ranked(this->slowest[function]);
+			sort(ranked.begin(), ranked.end(), [function](const Record& left, const Record& right)
+			{
+				return left.elapsed[function] > right.elapsed[function];
+			});
+
+			const string title = " Slowest Inputs of " + names[function];
+			cout << '\n' << title << '\n' << string(title.length(), '=') << "\n\n";
+			for(const Record& record : ranked)
+			{
+				cout << "  Record " << record.index;
+				if(!record.description.empty()) cout << " (" << record.description << ')';
+				cout << ": " << record.elapsed[function] / 1000.0 << " microseconds\n";
+				if(names.size() < 2) continue;
+				const char* separator = "    Relative to: ";
+				for(size_t other = 0; other < names.size(); ++other)
+				{
+					if(other == function) continue;
+					cout << separator << (record.elapsed[other] ? double(record.elapsed[function]) / record.elapsed[other] : 0.0)
+						 << "x " << names[other];
+					separator = ", ";
+				}
+				cout << '\n';
+			}
+		}
+		cout << endl;
+	}
+
+	/**
+	 * Copies the slowest records of every function from source into the file target, in
+	 * their original order and without duplicates. Returns the number of records written,
+	 * or -1 if a file could not be used or a record's place in source is unknown
+	 */
+	long dump(const std::string& source, const std::string& target) const
+	{
+		std::vector<const Record*> records;
+		for(const auto& heap : this->slowest)
+		{
+			for(const Record& record : heap) records.push_back(&record);
+		}
+		std::sort(records.begin(), records.end(), [](const Record* left, const Record* right) { return left->index < right->index; });
+		records.erase(std::unique(records.begin(), records.end(), [](const Record* left, const Record* right)
+		{
+			return left->index == right->index;
+		}), records.end());
+
+		std::ifstream in(source, std::ios::binary);
+		std::ofstream out(target, std::ios::binary);
+		if(!in || !out) return -1;
+		for(const Record* record : records)
+		{
+			if(record->begin < 0) return -1;
+			in.clear();
+			in.seekg(record->begin);
+			if(record->end < 0)
+			{
+				out << in.rdbuf();
+			} else {
+				std::string bytes(record->end - record->begin, '\0');
+				in.read(&bytes[0], bytes.size());
+				out.write(bytes.c_str(), in.gcount());
+			}
+		}
+		return out ? long(records.size()) : -1;
+	}
+private:
+	// slowest[f] is a heap of function f's slowest records, fastest on top
+	std::vector<std::vector<Record>> slowest;
+};
+#endif // TD_USE_OUTLIERS
+
+#endif // __TD_OUTLIERS_H
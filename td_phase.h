@@ -0,0 +1,153 @@
+//----------------------------------------------------------------------
+// DESCRIPTION: Phase markers for splitting the time of a test call
+//              into named intervals
+// ----------------------------------------------------------------------
+
+#ifndef __TD_PHASE_H
+#define __TD_PHASE_H
+
+/*
+TD_PHASE("name") marks the start of a phase inside a function under test; the phase runs
+until the next marker or the end of the call. Time from the start of the call to the first
+marker is reported as "unmarked". Markers are meant to be left in the code being tested,
+so they compile to nothing unless TD_USE_PHASES is defined, which has to be done before any
+header using TD_PHASE is included (e.g. on the compiler command line).
+
+While TestDriver is timing a call, a thread-local pointer refers to that call, and markers
+on the same thread record into the TD_TestFunction being timed. Markers reached outside of
+a timed call, or on other threads, are ignored.
+*/
+
+#ifdef TD_USE_PHASES
+#include <string>
+#include <vector>
+#include <chrono>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+// Per-phase times of one test function, with one sample per call the phase appeared in
+class TD_PhaseTable
+{
+public:
+	void add(const char* name, long long nanoseconds)
+	{
+		for(auto& phase : this->current)
+		{
+			if(!same_phase(phase.first, name)) continue;
+			phase.second += nanoseconds;
+			return;
+		}
+		this->current.emplace_back(name, nanoseconds);
+	}
+
+	// Files the times added since the last call to end_call() as one call's samples
+	void end_call()
+	{
+		for(const auto& phase : this->current)
+		{
+			auto found = std::find_if(this->samples.begin(), this->samples.end(),
+				[&phase](const auto& known) { return same_phase(known.first.c_str(), phase.first); });
+			if(found == this->samples.end())
+			{
+				this->samples.emplace_back(phase.first, std::vector<long long>());
+				found = this->samples.end() - 1;
+			}
+			found->second.push_back(phase.second);
+		}
+		this->current.clear();
+	}
+
+	void reset()
+	{
+		this->current.clear();
+		this->samples.clear();
+	}
+
+	void print() const
+	{
+		using namespace std;
+		if(this->samples.empty()) return;
+		long long total = 0;
+		for(const auto& phase : this->samples)
+		{
+			for(long long sample : phase.second) total += sample;
+		}
+		for(const auto& phase : this->samples)
+		{
+			vector<long long> sorted(phase.second);
+			sort(sorted.begin(), sorted.end());
+			long long phase_total = 0;
+			for(long long sample : sorted) phase_total += sample;
+			auto percentile = [&sorted](int p) { return sorted[(sorted.size() - 1) * p / 100] / 1000.0; };
+
+			cout << "  Phase" << " \"" << phase.first << "\"\n";
+			cout << "    Total........: " << phase_total / 1000.0 << " microseconds ("
+				 << (total ? (100.0 * phase_total) / total : 0.0) << "%) over " << sorted.size() << " calls\n";
+			cout << "    p50/p90/p99..: " << percentile(50) << " / " << percentile(90) << " / " << percentile(99)
+				 << " microseconds\n";
+		}
+	}
+private:
+	// Markers usually pass the same literal, so the pointers are compared before the names
+	static bool same_phase(const char* left, const char* right)
+	{
+		return left == right || !std::strcmp(left, right);
+	}
+
+	std::vector<std::pair<const char*, long long>> current;
+	std::vector<std::pair<std::string, std::vector<long long>>> samples;
+};
+
+// One timed call. Created by TD_TestDriver::timed() around the call to the function, and
+// destroyed after the call's end time is taken, since closing the call files its samples
+class TD_PhaseCall
+{
+public:
+	explicit TD_PhaseCall(TD_PhaseTable& table);
+	~TD_PhaseCall();
+
+	void mark(const char* name)
+	{
+		const auto now = std::chrono::steady_clock::now();
+		this->table.add(this->phase, std::chrono::duration_cast<std::chrono::nanoseconds>(now - this->phase_start).count());
+		this->phase = name;
+		this->phase_start = now;
+	}
+private:
+	TD_PhaseTable& table;
+	TD_PhaseCall* enclosing;
+	const char* phase;
+	std::chrono::steady_clock::time_point phase_start;
+};
+
+inline thread_local TD_PhaseCall* TD_active_phase_call = nullptr;
+
+inline TD_PhaseCall::TD_PhaseCall(TD_PhaseTable& table)
+: table(table)
+, enclosing(TD_active_phase_call)
+, phase("unmarked")
+, phase_start(std::chrono::steady_clock::now())
+{
+	TD_active_phase_call = this;
+}
+
+inline TD_PhaseCall::~TD_PhaseCall()
+{
+	this->mark(nullptr);
+	this->table.end_call();
+	TD_active_phase_call = this->enclosing;
+}
+
+inline void TD_phase_mark(const char* name)
+{
+	if(TD_active_phase_call) TD_active_phase_call->mark(name);
+}
+
+#define TD_PHASE(name) TD_phase_mark(name)
+#else
+#define TD_PHASE(name) ((void)0)
+#endif // TD_USE_PHASES
+
+#endif // __TD_PHASE_H
@@ -0,0 +1,245 @@
+//----------------------------------------------------------------------
+// DESCRIPTION: Sampling profiler limited to the calls being timed,
+//              writing folded stacks for flame graphs
+// ----------------------------------------------------------------------
+
+#ifndef __TD_PROFILE_H
+#define __TD_PROFILE_H
+
+/*
+With TD_USE_PROFILER defined, every test function gets a CPU profile. An ITIMER_PROF timer
+sends SIGPROF every TD_PROFILE_INTERVAL_US microseconds of process CPU time, and a sample is
+kept only if TestDriver::timed() is inside a call to a function at the time; the handler
+drops the rest. Input preparation, output handling and the driver itself are never sampled.
+The timer keeps running between calls rather than being stopped and restarted, because the
+kernel rounds the time left on a stopped timer up to a scheduler tick: calls shorter than a
+tick would restart it from a full tick every time, and never be sampled at all.
+
+The signal handler records the return addresses of the interrupted stack with backtrace()
+into a fixed buffer, which is emptied after each call. Stacks are symbolized only when the
+results are printed, and each function's profile is written to
+TD_PROFILE_PREFIX<function name>.folded in the folded format of flamegraph.pl
+("outer;inner;leaf count"), cut off at the function under test. Function names need the
+executable to export its symbols (-rdynamic); -fno-omit-frame-pointer keeps the stacks
+complete in code built without unwind tables.
+*/
+
+#ifdef TD_USE_PROFILER
+#include <string>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <sys/time.h>
+#include <ucontext.h>
+#include <execinfo.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+
+#ifndef TD_PROFILE_INTERVAL_US
+#define TD_PROFILE_INTERVAL_US 1000
+#endif // TD_PROFILE_INTERVAL_US
+#ifndef TD_PROFILE_PREFIX
+#define TD_PROFILE_PREFIX "profile_"
+#endif // TD_PROFILE_PREFIX
+
+// Deepest stack recorded, and most samples held before a call returns
+constexpr int TD_PROFILE_DEPTH = 64;
+constexpr int TD_PROFILE_BUFFER = 256;
+
+// Samples of one test function
+class TD_Profile
+{
+public:
+	// Called from the signal handler, on whichever thread of the call was interrupted, so
+	// it neither allocates nor locks. pc is the interrupted instruction, if known
+	void sample(void* pc)
+	{
+		const int slot = this->buffered.fetch_add(1, std::memory_order_relaxed);
+		if(slot >= TD_PROFILE_BUFFER)
+		{
+			this->dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		this->depths[slot] = backtrace(this->frames[slot], TD_PROFILE_DEPTH);
+		this->interrupted[slot] = pc;
+	}
+
+	// Moves the samples of the last call from the buffer to the stack counts
+	void drain()
+	{
+		const int buffered = this->buffered.load(std::memory_order_acquire);
+		const int samples = buffered < TD_PROFILE_BUFFER ? buffered : TD_PROFILE_BUFFER;
+		for(int slot = 0; slot < samples; ++slot)
+		{
+			// Skips the frames of the handler and the signal trampoline, which end where the
+			// interrupted instruction appears
+			int skipped = 0;
+			while(skipped < this->depths[slot] && this->frames[slot][skipped] != this->interrupted[slot]) ++skipped;
+			if(skipped == this->depths[slot]) skipped = 0;
+			++this->stacks[std::vector<void*>(this->frames[slot] + skipped, this->frames[slot] + this->depths[slot])];
+		}
+		this->buffered.store(0, std::memory_order_relaxed);
+	}
+
+	void reset()
+	{
+		this->stacks.clear();
+		this->dropped = 0;
+	}
+
+	/**
+	 * Writes the folded stacks to TD_PROFILE_PREFIX + name + ".folded", with every character
+	 * of name that is not a letter or a digit replaced, and reports it
+	 */
+	void write(const std::string& name) const
+	{
+		using namespace std;
+		if(this->stacks.empty()) return;
+
+		string filename(TD_PROFILE_PREFIX);
+		for(char c : name) filename += isalnum((unsigned char)c) ? c : '_';
+		filename += ".folded";
+
+		map<string, long> folded;
+		long samples = 0;
+		for(const auto& stack : this->stacks)
+		{
+			vector<string> names;
+			for(void* address : stack.first) names.push_back(symbol(address));
+			// Keeps the frames called from the function under test's TD_TestFunction, outermost first
+			size_t outermost = names.size();
+			for(size_t frame = 0; frame < names.size(); ++frame)
+			{
+				if(names[frame].compare(0, 16, "TD_TestFunction<") == 0 && names[frame].find(">::operator()") != string::npos)
+				{
+					outermost = frame;
+					break;
+				}
+			}
+			string line;
+			for(size_t frame = outermost; frame-- > 0;)
+			{
+				line += names[frame];
+				if(frame) line += ';';
+			}
+			folded[line] += stack.second;
+			samples += stack.second;
+		}
+
+		ofstream out(filename);
+		for(const auto& stack : folded) out << stack.first << ' ' << stack.second << '\n';
+		cout << "  Profile" << " Samples.: " << samples << " in " << filename;
+		if(this->dropped) cout << " (" << this->dropped << " dropped)";
+		cout << '\n';
+	}
+private:
+	// Demangled name of the function containing address, or the address itself
+	static std::string symbol(void* address)
+	{
+		// Return addresses point after the call, which may be past the end of the caller
+		const void* inside = static_cast<char*>(address) - 1;
+		Dl_info info;
+		if(!dladdr(inside, &info) || !info.dli_sname)
+		{
+			char hex[2 * sizeof(void*) + 3];
+			snprintf(hex, sizeof(hex), "%p", address);
+			return hex;
+		}
+		int status = 0;
+		char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+		std::string name(status == 0 && demangled ? demangled : info.dli_sname);
+		std::free(demangled);
+		// Drops the parameter list, which is mostly the same long types in every frame
+		const std::string qualifier = " const";
+		if(name.length() > qualifier.length() && name.compare(name.length() - qualifier.length(), qualifier.length(), qualifier) == 0)
+		{
+			name.erase(name.length() - qualifier.length());
+		}
+		if(!name.empty() && name.back() == ')')
+		{
+			int depth = 0;
+			for(std::size_t index = name.length(); index-- > 0;)
+			{
+				if(name[index] == ')') ++depth;
+				if(name[index] == '(' && !--depth)
+				{
+					name.erase(index);
+					break;
+				}
+			}
+		}
+		// ';' separates frames in the folded format
+		for(char& c : name)
+		{
+			if(c == ';') c = ':';
+		}
+		return name;
+	}
+
+	void* frames[TD_PROFILE_BUFFER][TD_PROFILE_DEPTH];
+	int depths[TD_PROFILE_BUFFER];
+	void* interrupted[TD_PROFILE_BUFFER];
+	std::atomic<int> buffered{0};
+	std::atomic<long> dropped{0};
+	std::map<std::vector<void*>, long> stacks;
+};
+
+// Profile of the call being timed, or nullptr between calls
+inline std::atomic<TD_Profile*> TD_profiled{nullptr};
+
+inline void TD_profile_signal(int, siginfo_t*, void* context)
+{
+	TD_Profile* profile = TD_profiled.load(std::memory_order_acquire);
+	if(!profile) return;
+	const mcontext_t& registers = static_cast<ucontext_t*>(context)->uc_mcontext;
+	#if defined(__x86_64__)
+	profile->sample(reinterpret_cast<void*>(registers.gregs[REG_RIP]));
+	#elif defined(__aarch64__)
+	profile->sample(reinterpret_cast<void*>(registers.pc));
+	#else
+	(void)registers;
+	profile->sample(nullptr);
+	#endif
+}
+
+/**
+ * Starts sampling into profile, for the duration of one call
+ */
+inline void TD_profile_resume(TD_Profile* profile)
+{
+	static const bool started = []()
+	{
+		// The first backtrace() loads the unwinder, which must not happen in the handler
+		void* frame;
+		backtrace(&frame, 1);
+		struct sigaction action = {};
+		action.sa_sigaction = TD_profile_signal;
+		action.sa_flags = SA_RESTART | SA_SIGINFO;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGPROF, &action, nullptr);
+		itimerval timer = {};
+		timer.it_interval.tv_usec = TD_PROFILE_INTERVAL_US % 1000000;
+		timer.it_interval.tv_sec = TD_PROFILE_INTERVAL_US / 1000000;
+		timer.it_value = timer.it_interval;
+		setitimer(ITIMER_PROF, &timer, nullptr);
+		return true;
+	}();
+	(void)started;
+	TD_profiled.store(profile, std::memory_order_release);
+}
+
+/**
+ * Stops sampling at the end of a call
+ */
+inline void TD_profile_pause()
+{
+	TD_profiled.store(nullptr, std::memory_order_release);
+}
+#endif // TD_USE_PROFILER
+
+#endif // __TD_PROFILE_H
@@ -0,0 +1,134 @@
+//----------------------------------------------------------------------
+// DESCRIPTION: Concurrent runs of one test function from 1..N threads,
+//              to measure throughput and latency under contention
+// ----------------------------------------------------------------------
+
+#ifndef __TD_SCALING_H
+#define __TD_SCALING_H
+
+/*
+With TD_USE_SCALING defined, TD_TestDriver::run_scaling_tests(filename, max_threads) reads
+every input in the file, then runs each function on all of them from 1, 2, 4, ... and
+max_threads threads at once. Every thread works on its own copy of the inputs, so the
+threads share nothing but the function under test, the allocator and the memory system,
+which is where they contend in a server running one search per request thread. The threads
+are released together once all of them have made their copies, and the run is timed from
+their release to the last thread finishing.
+
+For each thread count the report gives:
+- throughput, calls per second summed over all threads
+- the mean and p99 time of a single call, i.e. the latency one request sees
+- efficiency, throughput over thread count times the single thread throughput (1 is
+  linear scaling)
+
+TD_PRE_TIMER and TD_POST_TIMER run on every thread, so they may only touch input and
+output. TD_HANDLE_OUTPUT and the other per-call reports are not used in this mode.
+*/
+
+#ifdef TD_USE_SCALING
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+// Holds threads until all of them are ready, then releases them at once
+class TD_StartGate
+{
+public:
+	explicit TD_StartGate(int threads)
+	: waiting(threads)
+	{}
+
+	// Called by each thread when it is ready. Returns once the gate is opened
+	void arrive()
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		if(!--this->waiting) this->all_arrived.notify_all();
+		this->opened.wait(lock, [this] { return this->open; });
+	}
+
+	// Returns once every thread has arrived
+	void wait_for_all()
+	{
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->all_arrived.wait(lock, [this] { return !this->waiting; });
+	}
+
+	// Releases the threads
+	void release()
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->open = true;
+		this->opened.notify_all();
+	}
+private:
+	std::mutex mutex;
+	std::condition_variable all_arrived, opened;
+	int waiting;
+	bool open = false;
+};
+
+// Results of one function at each thread count
+class TD_ScalingTable
+{
+public:
+	/**
+	 * Records one run on threads threads that took seconds in total. latencies holds
+	 * the nanoseconds of every call, from every thread, and is reordered
+	 */
+	void add(int threads, double seconds, std::vector<long long>& latencies)
+	{
+		Point point{threads, 0, 0, 0};
+		if(!latencies.empty())
+		{
+			std::sort(latencies.begin(), latencies.end());
+			long double total = 0;
+			for(long long latency : latencies) total += latency;
+			point.throughput = seconds > 0 ? latencies.size() / seconds : 0;
+			point.mean_latency = total / latencies.size() / 1000.0;
+			point.p99_latency = latencies[(latencies.size() - 1) * 99 / 100] / 1000.0;
+		}
+		this->points.push_back(point);
+	}
+
+	void print(const std::string& name) const
+	{
+		using namespace std;
+		const string title = " Scaling of " + name;
+		cout << '\n' << title << '\n' << string(title.length(), '=') << "\n\n";
+		cout << "  Threads    Calls/Second    Mean (us)     p99 (us)   Efficiency\n";
+		const double single = this->points.empty() ? 0 : this->points.front().throughput;
+		for(const Point& point : this->points)
+		{
+			cout << setw(9) << point.threads << setw(16) << point.throughput << setw(13) << point.mean_latency
+				 << setw(13) << point.p99_latency << setw(13) << (single ? point.throughput / (single * point.threads) : 0.0)
+				 << '\n';
+		}
+		cout << endl;
+	}
+private:
+	struct Point
+	{
+		int threads;
+		double throughput, mean_latency, p99_latency;
+	};
+	std::vector<Point> points;
+};
+
+/**
+ * Thread counts for a scaling run: the powers of two below max_threads, then max_threads
+ */
+inline std::vector<int> TD_scaling_thread_counts(int max_threads)
+{
+	std::vector<int> counts;
+	for(int threads = 1; threads < max_threads; threads *= 2) counts.push_back(threads);
+	counts.push_back(max_threads < 1 ? 1 : max_threads);
+	return counts;
+}
+#endif // TD_USE_SCALING
+
+#endif // __TD_SCALING_H
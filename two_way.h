@@ -0,0 +1,182 @@
+//----------------------------------------------------------------------
+// FILE: two_way.h
+// DESC: Crochemore-Perrin Two-Way string search. Constant extra space
+//       and a linear worst case, for patterns that cannot be trusted
+//----------------------------------------------------------------------
+
+#ifndef TWO_WAY_H
+#define TWO_WAY_H
+
+#include <string>
+#include <list>
+#include <cstddef>
+#include "match_sinks.h"
+
+/**
+ * A pattern prepared for Two-Way search. Preparing finds the critical factorization of
+ * the pattern, pattern = u v with |u| = critical_position + 1, and the period to shift by
+ * after a match. That is two integers regardless of the pattern or alphabet, computed in
+ * O(m) time, which is what makes the search O(n + m) with O(1) extra space.
+ *
+ * The factorization only depends on the pattern, so a two_way_pattern can be kept and
+ * reused for any number of texts.
+ *
+ * References
+ * - M. Crochemore and D. Perrin, "Two-way string-matching", J. ACM 38(3), 1991
+ * - https://en.wikipedia.org/wiki/Two-way_string-matching_algorithm
+ */
+class two_way_pattern
+{
+public:
+	explicit two_way_pattern(const std::string& pattern);
+
+	/**
+	 * Reports every occurance of the pattern in text[0...text_length-1] to sink, and
+	 * returns true if there were any
+	 */
+	template<typename Sink>
+	bool search(const char* text, std::size_t text_length, Sink&& sink) const;
+
+	const std::string& pattern() const { return this->pattern_string; }
+	std::ptrdiff_t critical_position() const { return this->critical; }
+	std::ptrdiff_t period() const { return this->shift; }
+	// Whether the whole pattern has period period(), which selects the variant that
+	// remembers how much of the previous alignment is already known to match
+	bool periodic() const { return this->is_periodic; }
+private:
+	/**
+	 * Start of the maximal suffix of the pattern, by the ordering of bytes when reversed is
+	 * false and the opposite ordering when true, and the period of that suffix
+	 */
+	std::ptrdiff_t maximal_suffix(bool reversed, std::ptrdiff_t& period) const;
+
+	std::string pattern_string;
+	std::ptrdiff_t critical;
+	std::ptrdiff_t shift;
+	bool is_periodic;
+};
+
+two_way_pattern::two_way_pattern(const std::string& pattern)
+: pattern_string(pattern)
+, critical(-1)
+, shift(1)
+, is_periodic(false)
+{
+	const std::ptrdiff_t pattern_length = pattern.length();
+	if(!pattern_length) return;
+
+	// The critical factorization is whichever of the two maximal suffixes starts later
+	std::ptrdiff_t period, reversed_period;
+	const std::ptrdiff_t suffix = this->maximal_suffix(false, period);
+	const std::ptrdiff_t reversed_suffix = this->maximal_suffix(true, reversed_period);
+	if(suffix > reversed_suffix)
+	{
+		this->critical = suffix;
+		this->shift = period;
+	} else {
+		this->critical = reversed_suffix;
+		this->shift = reversed_period;
+	}
+
+	// If u is a suffix of the first period of the pattern, the local period is the period
+	// of the whole pattern. Otherwise no match can overlap the previous one by more than
+	// max(|u|, |v|), which gives the shift after a match
+	this->is_periodic = this->critical + 1 + this->shift <= pattern_length
+		&& !pattern.compare(0, this->critical + 1, pattern, this->shift, this->critical + 1);
+	if(!this->is_periodic)
+	{
+		const std::ptrdiff_t left = this->critical + 1;
+		const std::ptrdiff_t right = pattern_length - this->critical - 1;
+		this->shift = (left > right ? left : right) + 1;
+	}
+}
+
+std::ptrdiff_t two_way_pattern::maximal_suffix(bool reversed, std::ptrdiff_t& period) const
+{
+	const unsigned char* pattern = reinterpret_cast<const unsigned char*>(this->pattern_string.c_str());
+	const std::ptrdiff_t pattern_length = this->pattern_string.length();
+	// suffix is the start of the best suffix so far, minus one; candidate is the start of
+	// the suffix being compared against it, minus one; offset is how far into both
+	std::ptrdiff_t suffix = -1, candidate = 0, offset = 1;
+	period = 1;
+	while(candidate + offset < pattern_length)
+	{
+		const unsigned char a = pattern[candidate + offset];
+		const unsigned char b = pattern[suffix + offset];
+		if(reversed ? a > b : a < b)
+		{
+			// The candidate is smaller; everything up to here extends the current period
+			candidate += offset;
+			offset = 1;
+			period = candidate - suffix;
+		} else if(a == b) {
+			if(offset != period)
+			{
+				++offset;
+				continue;
+			}
+			candidate += period;
+			offset = 1;
+		} else {
+			// The candidate is larger, so it becomes the maximal suffix
+			suffix = candidate;
+			candidate = suffix + 1;
+			offset = period = 1;
+		}
+	}
+	return suffix;
+}
+
+template<typename Sink>
+bool two_way_pattern::search(const char* text_chars, std::size_t text_length, Sink&& sink) const
+{
+	const unsigned char* pattern = reinterpret_cast<const unsigned char*>(this->pattern_string.c_str());
+	const unsigned char* text = reinterpret_cast<const unsigned char*>(text_chars);
+	const std::ptrdiff_t pattern_length = this->pattern_string.length();
+	if(std::ptrdiff_t(text_length) < pattern_length) return false;
+	if(!pattern_length) return true;
+
+	const std::ptrdiff_t last_alignment = text_length - pattern_length;
+	bool found = false;
+	// memory is the end of the prefix of the pattern known to match at the current
+	// alignment from the previous one, or -1. Only the periodic variant ever sets it
+	std::ptrdiff_t memory = -1;
+	for(std::ptrdiff_t alignment = 0; alignment <= last_alignment;)
+	{
+		// Scan v, the right half, forwards
+		std::ptrdiff_t index = (this->critical > memory ? this->critical : memory) + 1;
+		while(index < pattern_length && pattern[index] == text[alignment + index]) ++index;
+		if(index < pattern_length)
+		{
+			// Mismatch in v: everything scanned can be skipped
+			alignment += index - this->critical;
+			memory = -1;
+			continue;
+		}
+		// Scan u, the left half, backwards
+		index = this->critical;
+		while(index > memory && pattern[index] == text[alignment + index]) --index;
+		if(index <= memory)
+		{
+			/***  MATCH  ***/
+			found = true;
+			if(!report_match(sink, alignment)) return true;
+		}
+		alignment += this->shift;
+		if(this->is_periodic) memory = pattern_length - this->shift - 1;
+	}
+	return found;
+}
+
+/**
+ * Two-Way search with the boyermoore() signature. The most recently used factorization
+ * is kept per thread, so a run of records that share a pattern only factors it once
+ */
+bool two_way(const std::string& pattern, const std::string& text, std::list<int>& matches)
+{
+	thread_local two_way_pattern compiled("");
+	if(compiled.pattern() != pattern) compiled = two_way_pattern(pattern);
+	return compiled.search(text.c_str(), text.length(), list_sink{matches});
+}
+
+#endif